@@ -0,0 +1,268 @@
+#include <random>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+#include "city_generator.h"
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для бенчмарков транспортного справочника
+namespace bench {
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue::bench
+namespace detail {
+
+// Генератор случайных чисел. Распределения стандартной библиотеки на разных платформах дают разные числа,
+// поэтому числа получаются прямо из mt19937_64, последовательность которого определена стандартом
+class Random {
+public:
+    explicit Random(uint64_t seed) : engine_(seed) { }
+
+    // Функция получения числа из [0, 1)
+    double NextDouble() {
+        return static_cast<double>(engine_() >> 11) * 0x1.0p-53;
+    }
+
+    // Функция получения числа из [0, n)
+    size_t NextIndex(size_t n) {
+        return static_cast<size_t>(engine_() % n);
+    }
+
+    // Функция получения true с вероятностью probability
+    bool Chance(double probability) {
+        return NextDouble() < probability;
+    }
+
+private:
+    mt19937_64 engine_;
+};
+
+// Функция выбора ближайшей к остановке from из нескольких случайных остановок (маршруты получаются из коротких перегонов)
+uint32_t PickNearbyStop(Random& random, const vector<CityStop>& stops, uint32_t from) {
+    constexpr size_t candidates_count = 8;
+
+    uint32_t best = from;
+    double best_distance = 0.0;
+
+    for (size_t i = 0; i < candidates_count; ++i) {
+        const uint32_t candidate = static_cast<uint32_t>(random.NextIndex(stops.size()));
+        if (candidate == from) continue;
+
+        const double distance = geo::ComputeDistance(stops[from].coordinate, stops[candidate].coordinate);
+        if (best == from || distance < best_distance) {
+            best = candidate;
+            best_distance = distance;
+        }
+    }
+
+    // Если все кандидаты совпали с исходной остановкой, берём соседнюю по номеру
+    if (best == from) best = static_cast<uint32_t>((from + 1) % stops.size());
+
+    return best;
+}
+
+// Функция задания дорожного расстояния от остановки from до остановки to (если оно ещё не задано)
+void AddDistance(Random& random, vector<CityStop>& stops, uint32_t from, uint32_t to) {
+    auto& distances = stops[from].distances;
+
+    if (any_of(distances.begin(), distances.end(), [to](const auto& distance) { return distance.first == to; })) return;
+
+    // Дорога длиннее расстояния по прямой в 1-1.6 раза
+    const double geo_distance = geo::ComputeDistance(stops[from].coordinate, stops[to].coordinate);
+    const int distance = max(1, static_cast<int>(ceil(geo_distance * (1.0 + 0.6 * random.NextDouble()))));
+
+    distances.push_back({ to, distance });
+}
+
+// Функция получения настроек отрисовки карты
+json::Dict MakeRenderSettings() {
+    using namespace json;
+
+    return Dict{ { "width"s,                1200.0 },
+                 { "height"s,               800.0 },
+                 { "padding"s,              50.0 },
+                 { "stop_radius"s,          5.0 },
+                 { "line_width"s,           14.0 },
+                 { "bus_label_font_size"s,  20 },
+                 { "bus_label_offset"s,     Array{ 7.0, 15.0 } },
+                 { "stop_label_font_size"s, 18 },
+                 { "stop_label_offset"s,    Array{ 7.0, -3.0 } },
+                 { "underlayer_color"s,     Array{ 255, 255, 255, 0.85 } },
+                 { "underlayer_width"s,     3.0 },
+                 { "color_palette"s,        Array{ "green"s, Array{ 255, 160, 0 }, "red"s } } };
+}
+
+}
+
+City::City(const CityConfig& config) : config_(config) {
+    using namespace detail;
+
+    Random random(config_.seed);
+
+    const size_t stops_count = max<size_t>(config_.stops_count, 2);
+
+    // Остановки равномерно разбросаны по прямоугольнику размером с большой город
+    stops_.reserve(stops_count);
+    for (size_t i = 0; i < stops_count; ++i) {
+        CityStop stop;
+        stop.name = "Stop "s + to_string(i);
+        stop.coordinate.lat = 55.55 + 0.35 * random.NextDouble();
+        stop.coordinate.lng = 37.35 + 0.50 * random.NextDouble();
+        stops_.push_back(move(stop));
+    }
+
+    // Маршруты - цепочки близких остановок, для каждого перегона задаётся дорожное расстояние
+    buses_.reserve(config_.buses_count);
+    for (size_t i = 0; i < config_.buses_count; ++i) {
+        CityBus bus;
+        bus.name = "Bus "s + to_string(i);
+        bus.is_roundtrip = random.Chance(config_.roundtrip_share);
+
+        const size_t bus_stops_count = max<size_t>(config_.stops_per_bus, 2);
+        bus.stops.push_back(static_cast<uint32_t>(random.NextIndex(stops_.size())));
+
+        while (bus.stops.size() + (bus.is_roundtrip ? 1 : 0) < bus_stops_count) {
+            bus.stops.push_back(PickNearbyStop(random, stops_, bus.stops.back()));
+        }
+
+        if (bus.is_roundtrip) bus.stops.push_back(bus.stops.front());
+
+        for (size_t j = 0; j + 1 < bus.stops.size(); ++j) {
+            if (bus.stops[j] != bus.stops[j + 1]) AddDistance(random, stops_, bus.stops[j], bus.stops[j + 1]);
+            else                                  AddDistance(random, stops_, bus.stops[j], bus.stops[j]);
+        }
+
+        buses_.push_back(move(bus));
+    }
+
+    // Дополнительные расстояния, не нужные маршрутам (плотность дорожной сети)
+    for (uint32_t from = 0; from < stops_.size(); ++from) {
+        const double extra = config_.distance_density;
+        size_t count = static_cast<size_t>(extra);
+        if (random.Chance(extra - static_cast<double>(count))) ++count;
+
+        for (size_t i = 0; i < count; ++i) {
+            AddDistance(random, stops_, from, PickNearbyStop(random, stops_, from));
+        }
+    }
+
+    // Названия для запросов: существующие и несуществующие
+    auto pick_stop_name = [&]() {
+        if (random.Chance(config_.missing_share)) return "Missing stop "s + to_string(random.NextIndex(1000));
+        return stops_[random.NextIndex(stops_.size())].name;
+    };
+    auto pick_bus_name = [&]() {
+        if (buses_.empty() || random.Chance(config_.missing_share)) return "Missing bus "s + to_string(random.NextIndex(1000));
+        return buses_[random.NextIndex(buses_.size())].name;
+    };
+
+    for (size_t i = 0; i < 1024; ++i) {
+        stop_queries_.push_back(pick_stop_name());
+        bus_queries_.push_back(pick_bus_name());
+    }
+
+    // Смесь запросов к справочнику
+    const double total_weight = config_.stop_weight + config_.bus_weight + config_.map_weight + config_.route_weight;
+
+    for (size_t id = 0; id < config_.requests_count; ++id) {
+        const double choice = random.NextDouble() * total_weight;
+        const int request_id = static_cast<int>(id + 1);
+
+        if (choice < config_.stop_weight) {
+            stat_requests_.push_back(json::Dict{ { "id"s, request_id }, { "type"s, "Stop"s }, { "name"s, pick_stop_name() } });
+        }
+        else if (choice < config_.stop_weight + config_.bus_weight) {
+            stat_requests_.push_back(json::Dict{ { "id"s, request_id }, { "type"s, "Bus"s }, { "name"s, pick_bus_name() } });
+        }
+        else if (choice < config_.stop_weight + config_.bus_weight + config_.map_weight) {
+            stat_requests_.push_back(json::Dict{ { "id"s, request_id }, { "type"s, "Map"s } });
+        }
+        else {
+            stat_requests_.push_back(json::Dict{ { "id"s, request_id }, { "type"s, "Route"s }, { "from"s, pick_stop_name() }, { "to"s, pick_stop_name() } });
+        }
+    }
+}
+
+// Функция получения запросов на заполнение базы данных (ссылаются на строки города)
+void City::GetBaseRequests(vector<request_handler::AddStopRequest>& add_stop_requests,
+                           vector<request_handler::AddBusRequest>&  add_bus_requests) const {
+    add_stop_requests.clear();
+    add_bus_requests.clear();
+
+    for (const CityStop& stop : stops_) {
+        request_handler::AddStopRequest request{ stop.name, stop.coordinate, {} };
+        for (const auto& [to, distance] : stop.distances) {
+            request.distances.push_back({ stops_[to].name, distance });
+        }
+        add_stop_requests.push_back(move(request));
+    }
+
+    for (const CityBus& bus : buses_) {
+        request_handler::AddBusRequest request{ bus.name, bus.is_roundtrip ? BusRouteType::Circle : BusRouteType::Line, {} };
+        for (uint32_t stop : bus.stops) {
+            request.stops.push_back(stops_[stop].name);
+        }
+        add_bus_requests.push_back(move(request));
+    }
+}
+
+// Функция получения названий остановок, по которым делаются запросы (вместе с несуществующими)
+const vector<string>& City::GetStopQueries() const {
+    return stop_queries_;
+}
+
+// Функция получения названий маршрутов, по которым делаются запросы (вместе с несуществующими)
+const vector<string>& City::GetBusQueries() const {
+    return bus_queries_;
+}
+
+// Функция получения документа с запросами в формате входного файла
+json::Document City::ToJson() const {
+    using namespace json;
+
+    Array base_requests;
+    base_requests.reserve(stops_.size() + buses_.size());
+
+    for (const CityStop& stop : stops_) {
+        Dict distances;
+        for (const auto& [to, distance] : stop.distances) {
+            distances.emplace(stops_[to].name, distance);
+        }
+
+        base_requests.push_back(Dict{ { "type"s,           "Stop"s },
+                                      { "name"s,           stop.name },
+                                      { "latitude"s,       stop.coordinate.lat },
+                                      { "longitude"s,      stop.coordinate.lng },
+                                      { "road_distances"s, move(distances) } });
+    }
+
+    for (const CityBus& bus : buses_) {
+        Array stops;
+        for (uint32_t stop : bus.stops) {
+            stops.push_back(stops_[stop].name);
+        }
+
+        base_requests.push_back(Dict{ { "type"s,         "Bus"s },
+                                      { "name"s,         bus.name },
+                                      { "stops"s,        move(stops) },
+                                      { "is_roundtrip"s, bus.is_roundtrip } });
+    }
+
+    return Document(Dict{ { "base_requests"s,    move(base_requests) },
+                          { "render_settings"s,  detail::MakeRenderSettings() },
+                          { "routing_settings"s, Dict{ { "bus_wait_time"s, 6 }, { "bus_velocity"s, 40.0 } } },
+                          { "stat_requests"s,    stat_requests_ } });
+}
+
+// Функция получения документа с запросами в формате входного файла в виде текста
+string City::ToJsonText() const {
+    ostringstream output;
+    ToJson().Print(output);
+    return output.str();
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "domain.h"
+#include "json.h"
+#include "request_handler.h"
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для бенчмарков транспортного справочника
+namespace bench {
+
+// Структура параметров синтетического города
+struct CityConfig {
+    uint64_t seed            = 42;   // Зерно генератора (одинаковое зерно - одинаковый город на любой платформе)
+    size_t   stops_count     = 2000; // Число остановок
+    size_t   buses_count     = 300;  // Число маршрутов
+    size_t   stops_per_bus   = 20;   // Число остановок на маршруте
+    double   distance_density = 2.0; // Число дополнительных дорожных расстояний на остановку (кроме нужных маршрутам)
+    double   roundtrip_share = 0.5;  // Доля кольцевых маршрутов
+
+    size_t requests_count = 2000;  // Число запросов к справочнику
+    double stop_weight    = 0.40;  // Доли типов запросов в смеси
+    double bus_weight     = 0.40;
+    double map_weight     = 0.005;
+    double route_weight   = 0.195;
+    double missing_share  = 0.05;  // Доля запросов к несуществующим остановкам и маршрутам
+};
+
+// Структура остановки синтетического города
+struct CityStop {
+    std::string     name;
+    geo::Coordinate coordinate;
+    std::vector<std::pair<uint32_t, int>> distances; // Дорожные расстояния до соседних остановок (номер остановки, метры)
+};
+
+// Структура маршрута синтетического города
+struct CityBus {
+    std::string           name;
+    bool                  is_roundtrip;
+    std::vector<uint32_t> stops; // Номера остановок (у кольцевого маршрута первая совпадает с последней)
+};
+
+// Класс синтетического города: остановки, маршруты и смесь запросов к справочнику
+class City {
+public:
+    explicit City(const CityConfig& config);
+
+    // Функция получения запросов на заполнение базы данных (ссылаются на строки города)
+    void GetBaseRequests(std::vector<request_handler::AddStopRequest>& add_stop_requests,
+                         std::vector<request_handler::AddBusRequest>&  add_bus_requests) const;
+
+    // Функция получения названий, по которым делаются запросы (вместе с несуществующими)
+    const std::vector<std::string>& GetStopQueries() const;
+    const std::vector<std::string>& GetBusQueries() const;
+
+    // Функция получения документа с запросами в формате входного файла
+    json::Document ToJson() const;
+
+    // Функция получения документа с запросами в формате входного файла в виде текста
+    std::string ToJsonText() const;
+
+private:
+    CityConfig config_;
+
+    std::vector<CityStop> stops_;
+    std::vector<CityBus>  buses_;
+
+    std::vector<std::string> stop_queries_;
+    std::vector<std::string> bus_queries_;
+    json::Array stat_requests_;
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include "city_generator.h"
+#include "transport_catalogue.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "json_reader.h"
+#include "catalogue_versions.h"
+#include "json.h"
+using namespace std;
+using namespace transport_catalogue;
+
+// Пространство имён для функций, использующихся только внутри бенчмарков
+namespace {
+
+using Clock = chrono::steady_clock;
+
+// Сумма результатов измеряемых операций (не даёт компилятору выбросить операции как ненужные)
+size_t sink = 0;
+
+// Структура параметров запуска бенчмарков
+struct BenchConfig {
+    bench::CityConfig city;
+    size_t repeat    = 5;      // Число повторов макро-бенчмарков
+    size_t lookups   = 200000; // Число вызовов в микро-бенчмарках запросов
+    size_t routes    = 2000;   // Число построений маршрутов
+};
+
+// Функция вывода строки отчёта: число операций, пропускная способность и перцентили задержки одной операции
+void Report(string_view name, vector<double>& samples, size_t ops_per_sample, double bytes_per_sample = 0.0) {
+    if (samples.empty()) return;
+
+    sort(samples.begin(), samples.end());
+
+    double total = 0.0;
+    for (double sample : samples) total += sample;
+
+    auto percentile = [&samples, ops_per_sample](double q) {
+        const size_t index = min(samples.size() - 1, static_cast<size_t>(q * static_cast<double>(samples.size())));
+        return samples[index] / static_cast<double>(ops_per_sample) * 1e6;
+    };
+
+    const double ops = static_cast<double>(samples.size() * ops_per_sample);
+
+    cout << left << setw(24) << name << right
+         << setw(10) << static_cast<size_t>(ops)
+         << setw(14) << fixed << setprecision(1) << ops / total;
+
+    if (bytes_per_sample > 0.0) cout << setw(10) << setprecision(1) << bytes_per_sample * static_cast<double>(samples.size()) / total / 1e6;
+    else                        cout << setw(10) << "-";
+
+    cout << setw(14) << setprecision(1) << percentile(0.50)
+         << setw(14) << percentile(0.90)
+         << setw(14) << percentile(0.99)
+         << setw(14) << samples.back() / static_cast<double>(ops_per_sample) * 1e6 << '\n';
+}
+
+// Функция измерения: operation вызывается samples_count раз, каждый вызов - один замер (в секундах)
+vector<double> Measure(size_t samples_count, const function<void()>& operation) {
+    vector<double> samples;
+    samples.reserve(samples_count);
+
+    for (size_t i = 0; i < samples_count; ++i) {
+        const auto start = Clock::now();
+        operation();
+        samples.push_back(chrono::duration<double>(Clock::now() - start).count());
+    }
+
+    return samples;
+}
+
+// Функция разбора числового параметра командной строки
+template <typename Number>
+void ParseArg(string_view value, Number& result) {
+    istringstream input{ string(value) };
+    input >> result;
+    if (!input) throw invalid_argument("Invalid argument value: "s + string(value));
+}
+
+// Функция разбора параметров командной строки
+BenchConfig ParseArgs(int argc, char* argv[]) {
+    BenchConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        const string_view key(argv[i]);
+        if (i + 1 >= argc) throw invalid_argument("Missing value for "s + string(key));
+        const string_view value(argv[++i]);
+
+        if      (key == "--seed"sv)          ParseArg(value, config.city.seed);
+        else if (key == "--stops"sv)         ParseArg(value, config.city.stops_count);
+        else if (key == "--buses"sv)         ParseArg(value, config.city.buses_count);
+        else if (key == "--stops-per-bus"sv) ParseArg(value, config.city.stops_per_bus);
+        else if (key == "--density"sv)       ParseArg(value, config.city.distance_density);
+        else if (key == "--requests"sv)      ParseArg(value, config.city.requests_count);
+        else if (key == "--stop-weight"sv)   ParseArg(value, config.city.stop_weight);
+        else if (key == "--bus-weight"sv)    ParseArg(value, config.city.bus_weight);
+        else if (key == "--map-weight"sv)    ParseArg(value, config.city.map_weight);
+        else if (key == "--route-weight"sv)  ParseArg(value, config.city.route_weight);
+        else if (key == "--repeat"sv)        ParseArg(value, config.repeat);
+        else if (key == "--lookups"sv)       ParseArg(value, config.lookups);
+        else if (key == "--routes"sv)        ParseArg(value, config.routes);
+        else throw invalid_argument("Unknown argument: "s + string(key));
+    }
+
+    return config;
+}
+
+// Функция получения настроек отрисовки карты с заданной шириной
+map_renderer::RenderSettings MakeRenderSettings(double width) {
+    map_renderer::RenderSettings settings;
+    settings.width = width;
+    settings.height = 800.0;
+    settings.padding = 50.0;
+    settings.line_width = 14.0;
+    settings.stop_radius = 5.0;
+    settings.bus_label_font_size = 20;
+    settings.bus_label_offset = { 7.0, 15.0 };
+    settings.stop_label_font_size = 18;
+    settings.stop_label_offset = { 7.0, -3.0 };
+    settings.underlayer_color = svg::Rgba(255, 255, 255, 0.85);
+    settings.underlayer_width = 3.0;
+    settings.color_palette = { "green"s, svg::Rgb(255, 160, 0), "red"s };
+    return settings;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    try {
+        config = ParseArgs(argc, argv);
+    }
+    catch (const exception& e) {
+        cerr << e.what() << '\n';
+        cerr << "Usage: transport_catalogue_bench [--seed N] [--stops N] [--buses N] [--stops-per-bus N] [--density X] [--requests N]\n"
+                "                                 [--stop-weight X] [--bus-weight X] [--map-weight X] [--route-weight X]\n"
+                "                                 [--repeat N] [--lookups N] [--routes N]\n";
+        return 1;
+    }
+
+    // Генерируем город
+    const auto generation_start = Clock::now();
+    const bench::City city(config.city);
+    const string input = city.ToJsonText();
+    const double generation_time = chrono::duration<double>(Clock::now() - generation_start).count();
+
+    cout << "City: "sv << config.city.stops_count << " stops, "sv << config.city.buses_count << " buses, "sv
+         << config.city.stops_per_bus << " stops per bus, "sv << config.city.requests_count << " stat requests, seed "sv << config.city.seed
+         << "; input "sv << input.size() / 1024 << " KiB, generated in "sv << fixed << setprecision(2) << generation_time << " s\n\n"sv;
+
+    cout << left << setw(24) << "benchmark"sv << right << setw(10) << "ops"sv << setw(14) << "ops/s"sv << setw(10) << "MB/s"sv
+         << setw(14) << "p50, us"sv << setw(14) << "p90, us"sv << setw(14) << "p99, us"sv << setw(14) << "max, us"sv << '\n';
+
+    // Разбор JSON
+    {
+        auto samples = Measure(config.repeat, [&input] { sink += json::Load(input).GetRoot().AsMap().size(); });
+        Report("json.Load"sv, samples, 1, static_cast<double>(input.size()));
+    }
+
+    {
+        auto samples = Measure(config.repeat, [&input] { sink += json::ArenaDocument(input).GetRoot().AsMap().size(); });
+        Report("json.ArenaDocument"sv, samples, 1, static_cast<double>(input.size()));
+    }
+
+    // Заполнение базы данных
+    vector<request_handler::AddStopRequest> add_stop_requests;
+    vector<request_handler::AddBusRequest>  add_bus_requests;
+    city.GetBaseRequests(add_stop_requests, add_bus_requests);
+
+    {
+        auto samples = Measure(config.repeat, [&] {
+            TransportCatalogue catalogue;
+            map_renderer::MapRenderer renderer(catalogue);
+            request_handler::RequestHandler handler(catalogue, renderer);
+            handler.SetData(add_stop_requests, add_bus_requests);
+            sink += catalogue.GetStops().size();
+        });
+        Report("SetData"sv, samples, 1);
+    }
+
+    // Изменение замороженной базы по одному расстоянию (значения не меняются, поэтому база остаётся прежней)
+    {
+        TransportCatalogue updated_catalogue;
+        map_renderer::MapRenderer updated_renderer(updated_catalogue);
+        request_handler::RequestHandler updated_handler(updated_catalogue, updated_renderer);
+        updated_handler.SetData(add_stop_requests, add_bus_requests);
+
+        vector<request_handler::SetDistanceRequest> distances;
+        for (const auto& request : add_stop_requests) {
+            for (const auto& [stop_to, distance] : request.distances) {
+                distances.push_back({ request.name, stop_to, distance });
+            }
+        }
+
+        if (!distances.empty()) {
+            constexpr size_t update_batch = 64;
+            size_t next = 0;
+            auto samples = Measure(config.repeat, [&] {
+                for (size_t i = 0; i < update_batch; ++i) {
+                    const auto& request = distances[next++ % distances.size()];
+                    updated_catalogue.UpdateDistance(request.from, request.to, request.distance);
+                }
+            });
+            Report("UpdateDistance"sv, samples, update_batch);
+        }
+    }
+
+    // Справочник для микро-бенчмарков
+    TransportCatalogue catalogue;
+    map_renderer::MapRenderer renderer(catalogue);
+    request_handler::RequestHandler handler(catalogue, renderer);
+    handler.SetRoutingSettings({ 6, 40.0 });
+    handler.SetData(add_stop_requests, add_bus_requests);
+
+    // Запросы информации об остановках и маршрутах (замер - пачка вызовов, чтобы не мерить сами часы)
+    constexpr size_t batch = 256;
+    {
+        const auto& names = city.GetStopQueries();
+        size_t next = 0;
+        auto samples = Measure(max<size_t>(config.lookups / batch, 1), [&] {
+            for (size_t i = 0; i < batch; ++i) {
+                const auto info = handler.GetStopInfo(names[next++ % names.size()]);
+                sink += info ? info->buses.size() : 0;
+            }
+        });
+        Report("GetStopInfo"sv, samples, batch);
+    }
+    {
+        const auto& names = city.GetBusQueries();
+        size_t next = 0;
+        auto samples = Measure(max<size_t>(config.lookups / batch, 1), [&] {
+            for (size_t i = 0; i < batch; ++i) {
+                const auto info = handler.GetBusInfo(names[next++ % names.size()]);
+                sink += info ? info->stops_number : 0;
+            }
+        });
+        Report("GetBusInfo"sv, samples, batch);
+    }
+
+    // Запросы информации об остановках через закреплённый снимок версионируемой базы
+    {
+        auto snapshot = make_unique<versioning::Snapshot>();
+        snapshot->handler.SetData(add_stop_requests, add_bus_requests);
+        const versioning::VersionedCatalogue versions(move(snapshot));
+
+        const auto& names = city.GetStopQueries();
+        size_t next = 0;
+        auto samples = Measure(max<size_t>(config.lookups / batch, 1), [&] {
+            for (size_t i = 0; i < batch; ++i) {
+                const auto pinned = versions.Pin();
+                const auto info = pinned->handler.GetStopInfo(names[next++ % names.size()]);
+                sink += info ? info->buses.size() : 0;
+            }
+        });
+        Report("Pin + GetStopInfo"sv, samples, batch);
+    }
+
+    // Построение маршрутов
+    {
+        const auto& names = city.GetStopQueries();
+        size_t next = 0;
+        RouteInfo route;
+        auto samples = Measure(config.routes, [&] {
+            const string& from = names[next++ % names.size()];
+            const string& to   = names[(next * 7) % names.size()];
+            sink += handler.BuildRoute(from, to, route) ? route.items.size() : 0;
+        });
+        Report("BuildRoute"sv, samples, 1);
+    }
+
+    // Отрисовка карты: без кэша (настройки меняются при каждом вызове) и из кэша
+    {
+        size_t next = 0;
+        auto samples = Measure(config.repeat, [&] {
+            ostringstream output;
+            handler.RenderMap(MakeRenderSettings(1200.0 + static_cast<double>(next++ % 2)), output);
+            sink += output.str().size();
+        });
+        Report("RenderMap (uncached)"sv, samples, 1);
+    }
+    {
+        const auto settings = MakeRenderSettings(1200.0);
+        auto samples = Measure(config.repeat * 10, [&] {
+            ostringstream output;
+            handler.RenderMap(settings, output);
+            sink += output.str().size();
+        });
+        Report("RenderMap (cached)"sv, samples, 1);
+    }
+
+    // Полная обработка входного файла (разбор, заполнение базы, ответы) в один и во все потоки
+    string output_text;
+    for (size_t threads : { size_t{ 1 }, static_cast<size_t>(max(1u, thread::hardware_concurrency())) }) {
+        json_reader::ProcessingSettings settings;
+        settings.threads_count = threads;
+
+        auto samples = Measure(config.repeat, [&] {
+            TransportCatalogue full_catalogue;
+            map_renderer::MapRenderer full_renderer(full_catalogue);
+            request_handler::RequestHandler full_handler(full_catalogue, full_renderer);
+
+            ostringstream output;
+            json_reader::RequestProcessing(full_handler, string_view(input), output, settings);
+            output_text = output.str();
+            sink += output_text.size();
+        });
+        Report("RequestProcessing x"s + to_string(threads), samples, 1, static_cast<double>(input.size()));
+
+        if (threads == 1 && thread::hardware_concurrency() <= 1) break;
+    }
+
+    // Вывод JSON: печать документа с ответами на все запросы
+    {
+        const json::Document responses = json::Load(output_text);
+        auto samples = Measure(config.repeat, [&] {
+            ostringstream output;
+            responses.Print(output);
+            sink += output.str().size();
+        });
+        Report("json.Print"sv, samples, 1, static_cast<double>(output_text.size()));
+
+        samples = Measure(config.repeat, [&] {
+            ostringstream output;
+            responses.Print(output, json::PrintFormat::Compact);
+            sink += output.str().size();
+        });
+        Report("json.Print compact"sv, samples, 1, static_cast<double>(output_text.size()));
+    }
+
+    cerr << "checksum "sv << sink << '\n';
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+#include "domain.h"
+#include "transport_catalogue.h"
+#include "json.h"
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с образом базы данных, который используется прямо из памяти
+namespace catalogue_image {
+
+// Ошибка открытия образа базы данных (неверный формат, другая версия формата, обрезанный файл)
+class ImageError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+// Версия формата образа (увеличивается при любом изменении формата)
+inline constexpr uint32_t IMAGE_VERSION = 1;
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue::catalogue_image
+namespace detail {
+
+// Заголовок образа: размеры и смещения (от начала образа) всех его разделов.
+// Все разделы - массивы записей фиксированного размера без указателей, выровненные на 8 байт
+struct ImageHeader {
+    char     signature[8];
+    uint32_t version;
+    uint32_t stops_count;      // Число остановок
+    uint32_t buses_count;      // Число маршрутов
+    uint32_t stop_buses_count; // Суммарная длина списков маршрутов на остановках
+    uint32_t bus_stops_count;  // Суммарная длина списков остановок маршрутов
+    uint32_t distances_count;  // Число дорожных расстояний (вместе с достроенными обратными)
+    uint64_t names_offset;     // Названия остановок и маршрутов подряд
+    uint64_t names_size;
+    uint64_t stops_offset;            // Записи остановок, упорядоченные по названию
+    uint64_t stop_buses_offset;       // Маршруты на остановках (номера записей маршрутов)
+    uint64_t buses_offset;            // Записи маршрутов, упорядоченные по названию
+    uint64_t bus_stops_offset;        // Остановки маршрутов (номера записей остановок)
+    uint64_t distance_offsets_offset; // Начало участка расстояний каждой остановки (CSR)
+    uint64_t distances_offset;        // Расстояния всех остановок подряд
+    uint64_t image_size;              // Полный размер образа
+};
+
+// Запись остановки
+struct StopRecord {
+    double   lat;
+    double   lng;
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t buses_begin; // Участок в разделе маршрутов на остановках
+    uint32_t buses_end;
+};
+
+// Запись маршрута (статистика маршрута посчитана заранее)
+struct BusRecord {
+    double   route_length;
+    double   curvature;
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t stops_begin; // Участок в разделе остановок маршрутов
+    uint32_t stops_end;
+    uint32_t stops_number;
+    uint32_t unique_stops_number;
+    uint32_t type;        // 1 - кольцевой, 0 - линейный
+    uint32_t reserved;
+};
+
+// Запись дорожного расстояния
+struct DistanceRecord {
+    uint32_t to;
+    int32_t  distance;
+};
+
+}
+
+// Функция сохранения замороженной базы данных в виде образа, который можно использовать прямо из памяти.
+// Идентификаторы остановок и маршрутов в образе - номера в порядке названий, а не идентификаторы справочника
+void SaveImage(std::ostream& output, const TransportCatalogue& catalogue);
+
+// Функция сохранения образа базы данных в файл
+void SaveImageToFile(const std::string& file, const TransportCatalogue& catalogue);
+
+// Класс справочника только для чтения поверх отображённого в память образа базы данных.
+// Образ не разбирается при открытии: запросы читают записи прямо из отображения, поэтому
+// несколько процессов, открывших один файл, делят одну копию данных в страничном кэше.
+// В собственной памяти объекта только представления названий маршрутов на остановках, чтобы GetStopInfo
+// возвращал тот же StopInfo, что и TransportCatalogue. Названия в ответах действительны, пока жив объект
+class MappedCatalogue {
+public:
+    explicit MappedCatalogue(const std::string& file);
+
+    // Функция получения числа остановок
+    size_t GetStopsCount() const;
+
+    // Функция получения числа маршрутов
+    size_t GetBusesCount() const;
+
+    // Функция поиска номера остановки в образе по её названию
+    std::optional<StopId> FindStopId(std::string_view name) const;
+
+    // Функция поиска номера маршрута в образе по его названию
+    std::optional<BusId> FindBusId(std::string_view name) const;
+
+    // Функция получения дорожного расстояния между остановками (если прямого нет, то берётся обратное)
+    std::optional<int> GetDistance(StopId from, StopId to) const;
+
+    // Функция получения информации об остановке
+    std::optional<StopInfo> GetStopInfo(std::string_view name) const;
+
+    // Функция получения информации о маршруте
+    std::optional<BusInfo> GetBusInfo(std::string_view name) const;
+
+private:
+    // Функция получения названия по его положению в разделе названий
+    std::string_view GetName(uint32_t offset, uint32_t length) const;
+
+    json::MappedFile file_;
+
+    const detail::ImageHeader*    header_           = nullptr;
+    const char*                   names_            = nullptr;
+    const detail::StopRecord*     stops_            = nullptr;
+    const uint32_t*               stop_buses_       = nullptr;
+    const detail::BusRecord*      buses_            = nullptr;
+    const uint32_t*               distance_offsets_ = nullptr;
+    const detail::DistanceRecord* distances_        = nullptr;
+
+    std::vector<std::string_view> stop_bus_names_; // Названия маршрутов на остановках (в порядке раздела маршрутов на остановках)
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "transport_catalogue.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "serialization.h"
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с версиями базы данных, которые подменяются во время работы сервера
+namespace versioning {
+
+// Снимок базы данных: справочник вместе с отрисовщиком карты, обработчиком запросов и настройками отрисовки.
+// После публикации снимок не изменяется, поэтому читатели обращаются к нему без блокировок
+struct Snapshot {
+    Snapshot() = default;
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator = (const Snapshot&) = delete;
+
+    TransportCatalogue                          catalogue;
+    map_renderer::MapRenderer                   renderer{ catalogue };
+    request_handler::RequestHandler             handler{ catalogue, renderer };
+    std::optional<map_renderer::RenderSettings> render_settings; // Настройки отрисовки карты, сохранённые вместе с базой
+    uint64_t                                    version = 0;     // Номер версии (присваивается при публикации)
+};
+
+// Функция загрузки снимка базы данных из бинарного файла (справочник заморожен, граф маршрутов построен)
+std::unique_ptr<Snapshot> LoadSnapshot(const serialization::SerializationSettings& serialization_settings);
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue::versioning
+namespace detail {
+
+// Слот читателя: эпоха, в которую читатель закрепил снимок. Каждый слот занимает свою кэш-линию,
+// чтобы читатели в разных потоках не мешали друг другу
+struct alignas(64) ReaderSlot {
+    static constexpr uint64_t IDLE = UINT64_MAX; // Слот свободен
+
+    std::atomic<uint64_t> epoch{ IDLE };
+};
+
+}
+
+// Класс версионируемой базы данных в духе RCU. Текущий снимок публикуется атомарной подменой указателя.
+// Читатель закрепляет снимок (Pin) на время обработки пакета запросов: отмечает в свободном слоте текущую эпоху
+// и читает указатель, не захватывая мьютексов и не трогая общих счётчиков ссылок. Писатель строит следующий снимок
+// отдельно и публикует его (Publish), а предыдущий откладывает до тех пор, пока не отпустят все читатели,
+// закрепившие снимок раньше публикации (то есть пока эпоха всех занятых слотов не станет не меньше эпохи удаления).
+// Тот, кто ждёт читателей (освобождения слота или отложенных снимков), спит на условной переменной,
+// а читатель, освобождая слот, будит его только тогда, когда кто-то ждёт
+class VersionedCatalogue {
+public:
+    // Класс закреплённого снимка: пока объект существует, снимок не удаляется
+    class PinnedSnapshot {
+    public:
+        PinnedSnapshot(PinnedSnapshot&& other) noexcept;
+        PinnedSnapshot& operator = (PinnedSnapshot&&) = delete;
+
+        PinnedSnapshot(const PinnedSnapshot&) = delete;
+        PinnedSnapshot& operator = (const PinnedSnapshot&) = delete;
+
+        ~PinnedSnapshot();
+
+        const Snapshot& operator * () const { return *snapshot_; }
+        const Snapshot* operator -> () const { return snapshot_; }
+
+    private:
+        friend class VersionedCatalogue;
+
+        PinnedSnapshot(const VersionedCatalogue* owner, detail::ReaderSlot* slot, const Snapshot* snapshot);
+
+        const VersionedCatalogue* owner_;
+        detail::ReaderSlot*       slot_;
+        const Snapshot*           snapshot_;
+    };
+
+    explicit VersionedCatalogue(std::unique_ptr<Snapshot> snapshot);
+
+    // Деструктор удаляет все снимки, поэтому к этому моменту читателей остаться не должно
+    ~VersionedCatalogue();
+
+    VersionedCatalogue(const VersionedCatalogue&) = delete;
+    VersionedCatalogue& operator = (const VersionedCatalogue&) = delete;
+
+    // Функция закрепления текущего снимка (можно одновременно вызывать из любого числа потоков).
+    // Если все слоты читателей заняты, функция ждёт освобождения любого из них
+    PinnedSnapshot Pin() const;
+
+    // Функция публикации следующего снимка. Предыдущий снимок удаляется сразу, если его никто не читает,
+    // иначе - при одном из следующих вызовов Publish или Reclaim. Возвращает номер версии опубликованного снимка
+    uint64_t Publish(std::unique_ptr<Snapshot> snapshot);
+
+    // Функция удаления отложенных снимков, которые больше никто не читает. Возвращает число оставшихся отложенных снимков
+    size_t Reclaim();
+
+    // Функция ожидания, пока отпустят все читатели отложенных снимков, и удаления этих снимков
+    void ReclaimAll();
+
+    // Функция получения номера версии текущего снимка
+    uint64_t GetVersion() const;
+
+private:
+    // Число слотов читателей: если все заняты, читатель ждёт освобождения любого из них
+    static constexpr size_t READER_SLOTS = 64;
+
+    // Функция освобождения слота читателя (будит ожидающих читателей, если они есть)
+    void Unpin(detail::ReaderSlot& slot) const;
+
+    // Функция получения самой ранней эпохи, которую ещё может читать кто-то из читателей
+    uint64_t GetMinReaderEpoch() const;
+
+    // Функция удаления отложенных снимков (вызывается под writer_mutex_)
+    size_t ReclaimLocked();
+
+    std::atomic<Snapshot*> current_;       // Текущий снимок
+    std::atomic<uint64_t>  epoch_{ 1 };    // Текущая эпоха (увеличивается при каждой публикации)
+
+    mutable std::array<detail::ReaderSlot, READER_SLOTS> slots_; // Слоты читателей
+
+    mutable std::atomic<size_t>     waiters_{ 0 };    // Число потоков, ждущих освобождения слотов
+    mutable std::mutex              readers_mutex_;   // Мьютекс ожидания читателей
+    mutable std::condition_variable reader_released_; // Уведомление об освобождении слота
+
+    std::mutex writer_mutex_;                                            // Мьютекс писателей
+    std::vector<std::pair<uint64_t, std::unique_ptr<Snapshot>>> retired_; // Отложенные снимки с эпохой удаления
+};
+
+}
+
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <cstdint>
 #include "geo.h"
 
 // Пространство имён транспортного справочника
@@ -12,23 +13,58 @@ enum class BusRouteType {
 	Line    // Линейный
 };
 
+// Идентификатор остановки (плотный номер остановки в базе данных)
+using StopId = uint32_t;
+
+// Идентификатор маршрута (плотный номер маршрута в базе данных)
+using BusId = uint32_t;
+
 // Структура остановки
 struct Stop {
-	std::string name;
+	std::string_view name; // Название (хранится в базе данных)
 	geo::Coordinate coordinate;
 };
 
 // Структура маршрута
 struct Bus {
-	std::string name;
-	std::vector<Stop*> stops;
+	std::string_view name;      // Название (хранится в базе данных)
+	std::vector<StopId> stops;  // Идентификаторы остановок на маршруте
 	BusRouteType type;
 };
 
-// Структура с информацией об остановке (её возвращает метод GetStopInfo)
+// Структура явно заданного дорожного расстояния от одной остановки до другой
+struct RoadDistance {
+	StopId from;
+	StopId to;
+	int    distance; // Расстояние в метрах
+};
+
+// Представление непрерывного участка элементов, которыми владеет кто-то другой (аналог std::span из C++20)
+template <typename T>
+class Span {
+public:
+	Span() = default;
+	Span(const T* data, size_t size) : data_(data), size_(size) { }
+	Span(const std::vector<T>& items) : data_(items.data()), size_(items.size()) { }
+
+	const T* begin() const { return data_; }
+	const T* end()   const { return data_ + size_; }
+
+	size_t size()  const { return size_; }
+	bool   empty() const { return size_ == 0; }
+
+	const T& operator [] (size_t index) const { return data_[index]; }
+
+private:
+	const T* data_ = nullptr;
+	size_t   size_ = 0;
+};
+
+// Структура с информацией об остановке (её возвращает метод GetStopInfo). Список маршрутов не копируется:
+// он указывает в базу данных и действителен, пока база не изменяется
 struct StopInfo {
-	std::string_view name;               // Название
-	std::vector<std::string_view> buses; // Маршруты, проходящие через остановку
+	std::string_view       name;  // Название
+	Span<std::string_view> buses; // Маршруты, проходящие через остановку (упорядочены по названию)
 };
 
 // Структура с информацией о маршруте (её возвращает метод GetBusInfo)
@@ -40,4 +76,30 @@ struct BusInfo {
 	double curvature;           // Извилистость
 };
 
+// Тип элемента маршрута поездки
+enum class RouteItemType {
+	Wait, // Ожидание автобуса на остановке
+	Bus   // Поездка на автобусе
+};
+
+// Структура элемента маршрута поездки
+struct RouteItem {
+	RouteItemType    type;       // Тип элемента
+	std::string_view name;       // Название остановки (для ожидания) или маршрута (для поездки)
+	uint32_t         span_count; // Число проезжаемых остановок (для поездки)
+	double           time;       // Время в минутах
+};
+
+// Структура с информацией о маршруте поездки между остановками (её заполняет метод BuildRoute)
+struct RouteInfo {
+	double total_time = 0.0;       // Общее время поездки в минутах
+	std::vector<RouteItem> items;  // Элементы маршрута поездки (ожидания и поездки по очереди)
+};
+
+// Структура остановки, найденной рядом с заданной точкой
+struct NearbyStop {
+	std::string_view name;     // Название
+	double           distance; // Расстояние до точки в метрах
+};
+
 }
\ No newline at end of file
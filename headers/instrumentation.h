@@ -0,0 +1,86 @@
+#pragma once
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с измерением времени работы этапов обработки запросов.
+// Измерения включаются опцией сборки TRANSPORT_CATALOGUE_INSTRUMENTATION; без неё макросы ниже
+// раскрываются в пустые инструкции и не стоят ничего
+namespace instrumentation {
+
+// Этапы обработки запросов
+enum class Phase : size_t {
+    JsonParse,         // Разбор JSON
+    BaseRequests,      // Обработка запросов на заполнение базы данных
+    SetData,           // Заполнение справочника
+    UpdateData,        // Изменение справочника пакетом изменений
+    Freeze,            // Заморозка справочника
+    RouterBuild,       // Построение графа маршрутов
+    SpatialIndexBuild, // Построение пространственного индекса остановок
+    StatRequests,      // Обработка запросов к справочнику (целиком)
+    StatStop,          // Запросы информации об остановке
+    StatBus,           // Запросы информации о маршруте
+    StatMap,           // Запросы карты маршрутов
+    StatRoute,         // Запросы построения маршрута поездки
+    StatNearby,        // Запросы поиска остановок рядом с точкой
+    RenderMap,         // Отрисовка карты маршрутов
+    Print,             // Вывод ответов
+    Count
+};
+
+#ifdef TRANSPORT_CATALOGUE_INSTRUMENTATION
+
+// Класс замера этапа: время и число выделений памяти (в текущем потоке) от создания до разрушения объекта
+// добавляются к статистике этапа. Вложенные этапы учитываются и в объемлющих
+class ScopedPhase {
+public:
+    explicit ScopedPhase(Phase phase);
+    ~ScopedPhase();
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator = (const ScopedPhase&) = delete;
+
+private:
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t allocations_;
+};
+
+// Функция сброса накопленной статистики
+void Reset();
+
+// Функция вывода накопленной статистики в формате JSON
+void WriteSummary(std::ostream& output);
+
+// Функция вывода накопленной статистики в файл из переменной окружения TRANSPORT_CATALOGUE_METRICS_FILE
+// (если она не задана - в стандартный поток ошибок)
+void EmitSummary();
+
+#define TRANSPORT_CATALOGUE_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define TRANSPORT_CATALOGUE_CONCAT(lhs, rhs) TRANSPORT_CATALOGUE_CONCAT_IMPL(lhs, rhs)
+
+// Замер этапа до конца текущей области видимости
+#define TRANSPORT_CATALOGUE_SCOPED_PHASE(phase) \
+    ::transport_catalogue::instrumentation::ScopedPhase TRANSPORT_CATALOGUE_CONCAT(scoped_phase_, __LINE__)(::transport_catalogue::instrumentation::Phase::phase)
+
+// Сброс статистики перед обработкой запросов
+#define TRANSPORT_CATALOGUE_RESET_METRICS() ::transport_catalogue::instrumentation::Reset()
+
+// Вывод статистики после обработки запросов
+#define TRANSPORT_CATALOGUE_EMIT_METRICS() ::transport_catalogue::instrumentation::EmitSummary()
+
+#else
+
+#define TRANSPORT_CATALOGUE_SCOPED_PHASE(phase) ((void)0)
+#define TRANSPORT_CATALOGUE_RESET_METRICS() ((void)0)
+#define TRANSPORT_CATALOGUE_EMIT_METRICS() ((void)0)
+
+#endif
+
+}
+
+}
\ No newline at end of file
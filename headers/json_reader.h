@@ -1,6 +1,14 @@
 #pragma once
 #include <iostream>
+#include <string_view>
+#include <optional>
+#include <functional>
+#include <memory>
 #include "request_handler.h"
+#include "catalogue_versions.h"
+#include "catalogue_image.h"
+#include "thread_pool.h"
+#include "json.h"
 
 // Пространство имён транспортного справочника
 namespace transport_catalogue {
@@ -13,8 +21,51 @@ public:
     using runtime_error::runtime_error;
 };
 
+// Структура настроек обработки запросов
+struct ProcessingSettings {
+    size_t threads_count = 1;                                // Число потоков для обработки запросов к справочнику (1 - последовательная обработка)
+    json::PrintFormat output_format = json::PrintFormat::Pretty; // Формат вывода ответов
+};
+
 // Функция обработки запросов к транспортному справочнику в формате JSON
-void RequestProcessing(request_handler::RequestHandler& request_handler, std::istream& input = std::cin, std::ostream& output = std::cout);
+void RequestProcessing(request_handler::RequestHandler& request_handler, std::istream& input = std::cin, std::ostream& output = std::cout,
+                       const ProcessingSettings& settings = {});
+
+// Функция обработки запросов к транспортному справочнику в формате JSON, целиком находящихся в непрерывном буфере
+void RequestProcessing(request_handler::RequestHandler& request_handler, std::string_view input, std::ostream& output = std::cout,
+                       const ProcessingSettings& settings = {});
+
+// Функция создания бинарной базы данных по запросам на заполнение базы в формате JSON (режим make_base)
+void MakeBase(request_handler::RequestHandler& request_handler, std::string_view input);
+
+// Функция обработки запросов к справочнику, база данных которого загружается из бинарного файла (режим process_requests)
+void ProcessRequests(request_handler::RequestHandler& request_handler, std::string_view input, std::ostream& output = std::cout,
+                     const ProcessingSettings& settings = {});
+
+// Класс обработчика потока пакетов запросов в формате NDJSON для режима сервера: на каждый пакет запросов
+// (строку входного потока) выводится строка с ответами. Каждый пакет обрабатывается целиком по одному снимку базы,
+// закреплённому на время пакета, поэтому новую версию базы можно опубликовать, не останавливая обработку.
+// Метод Process можно одновременно вызывать из нескольких потоков для разных соединений: все они обрабатывают
+// запросы общим пулом потоков, который создаётся один раз вместе с обработчиком.
+// Вместо версий базы обработчик может отвечать по образу базы данных: образ не загружается, а отображается в память,
+// но в нём есть только остановки и маршруты, поэтому на запросы Route, Nearby и Map выводится ошибка "not supported"
+class BatchProcessor {
+public:
+    explicit BatchProcessor(const versioning::VersionedCatalogue& catalogue, const ProcessingSettings& settings = {});
+
+    explicit BatchProcessor(const catalogue_image::MappedCatalogue& image, const ProcessingSettings& settings = {});
+
+    // Функция обработки потока пакетов запросов (разбор следующих пакетов идёт параллельно с обработкой текущего).
+    // close_input прерывает ожидание данных во входном потоке: она вызывается, если ответы выводить больше некуда.
+    // Без неё обработка в этом случае завершается только с концом входного потока
+    void Process(std::istream& input, std::ostream& output, const std::function<void()>& close_input = nullptr) const;
+
+private:
+    const versioning::VersionedCatalogue*   catalogue_ = nullptr; // Версии базы данных (нет при ответах по образу)
+    const catalogue_image::MappedCatalogue* image_     = nullptr; // Образ базы данных (нет при ответах по версиям базы)
+    ProcessingSettings                      settings_;
+    std::unique_ptr<threading::ThreadPool>  pool_;                // Пул потоков обработки запросов (нет при последовательной обработке)
+};
 
 }
 
@@ -5,6 +5,9 @@
 #include <cstdint>
 #include <algorithm>
 #include <optional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include "transport_catalogue.h"
 #include "svg.h"
 
@@ -86,6 +89,19 @@ private:
     double zoom_coeff_ = 0;
 };
 
+// Структура модели отрисовки карты: отсортированные маршруты и остановки и их точки на карте
+struct RenderModel {
+    uint64_t catalogue_version; // Версия справочника, по которой построена модель
+
+    double width;   // Размеры карты, для которых спроецированы точки
+    double height;
+    double padding;
+
+    std::vector<BusId>      buses;       // Непустые маршруты в алфавитном порядке
+    std::vector<StopId>     stops;       // Остановки, через которые проходят маршруты, в алфавитном порядке
+    std::vector<svg::Point> stop_points; // Точки остановок на карте (индекс - идентификатор остановки)
+};
+
 }
 
 // Эти псевдонимы нужны модулю json_reader для парсинга настроек отрисовки карты маршрутов 
@@ -114,29 +130,49 @@ struct RenderSettings {
     std::vector<svg::Color> color_palette;
 };
 
+bool operator == (const RenderSettings& lhs, const RenderSettings& rhs);
+bool operator != (const RenderSettings& lhs, const RenderSettings& rhs);
+
 // Класс отрисовщика карты маршрутов
 class MapRenderer {
 public:
     MapRenderer(const TransportCatalogue& catalogue);
 
-    // Функция отрисовки карты маршрутов
+    // Функция отрисовки карты маршрутов. Результат запоминается и выводится повторно без отрисовки,
+    // пока не изменятся настройки отрисовки или справочник. Безопасна для вызова из нескольких потоков
     void RenderMap(const RenderSettings& settings, std::ostream& output = std::cout) const;
 
 private:
+    // Структура запомненной карты маршрутов
+    struct RenderedMap {
+        RenderSettings settings;     // Настройки, с которыми отрисована карта
+        uint64_t catalogue_version;  // Версия справочника, по которой отрисована карта
+        std::string svg;             // Отрисованный SVG-документ
+    };
+
+    // Функция получения модели отрисовки (модель перестраивается, только если изменился справочник или размеры карты)
+    const detail::RenderModel& GetRenderModel(const RenderSettings& settings) const;
+
+    // Функция отрисовки карты маршрутов в строку с SVG-документом
+    std::string RenderMapDocument(const RenderSettings& settings) const;
 
     // Функция отрисовки линий маршрутов на карте маршрутов
-    void RenderRoutesPaths(svg::Document& document, const detail::SphereProjector& projector, const RenderSettings& settings) const;
+    void RenderRoutesPaths(svg::FlatDocument& document, const detail::RenderModel& model, const RenderSettings& settings) const;
 
     // Функция отрисовки названий маршрутов на карте маршрутов
-    void RenderRoutesNames(svg::Document& document, const detail::SphereProjector& projector, const RenderSettings& settings) const;
+    void RenderRoutesNames(svg::FlatDocument& document, const detail::RenderModel& model, const RenderSettings& settings) const;
 
     // Функция отрисовки точек остановок на карте маршрутов
-    void RenderRoutesStopsPoints(svg::Document& document, const detail::SphereProjector& projector, const RenderSettings& settings) const;
+    void RenderRoutesStopsPoints(svg::FlatDocument& document, const detail::RenderModel& model, const RenderSettings& settings) const;
 
     // Функция отрисовки названий остановок на карте маршрутов
-    void RenderRoutesStopsNames(svg::Document& document, const detail::SphereProjector& projector, const RenderSettings& settings) const;
+    void RenderRoutesStopsNames(svg::FlatDocument& document, const detail::RenderModel& model, const RenderSettings& settings) const;
 
     const TransportCatalogue& catalogue_;
+
+    mutable std::mutex cache_mutex_;                         // Мьютекс для кэша отрисованной карты
+    mutable std::shared_ptr<const RenderedMap> cached_map_;  // Последняя отрисованная карта
+    mutable std::optional<detail::RenderModel> render_model_; // Модель отрисовки (доступ под cache_mutex_)
 };
 
 }
@@ -0,0 +1,59 @@
+#pragma once
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Индекс "Название" -> "Идентификатор" для названий остановок или маршрутов (поиск без хеш-таблицы после Build)
+class NameIndex {
+public:
+    // Функция задания идентификатора для названия (повторное задание перезаписывает идентификатор).
+    // Название не копируется и должно оставаться действительным, пока существует индекс
+    void Set(std::string_view name, uint32_t id);
+
+    // Функция удаления названия. Возвращает false, если названия нет в индексе
+    bool Erase(std::string_view name);
+
+    // Функция поиска идентификатора по названию
+    std::optional<uint32_t> Find(std::string_view name) const;
+
+    // Функция построения совершенной хеш-функции по всем названиям индекса
+    // (если подобрать её не удалось, индекс остаётся хеш-таблицей)
+    void Build();
+
+private:
+    // Ячейка таблицы: название и его идентификатор
+    struct Slot {
+        const char* data   = nullptr;
+        uint32_t    length = 0;
+        uint32_t    id     = NO_ID;
+    };
+
+    // Метка удалённого названия
+    static constexpr uint32_t NO_ID = UINT32_MAX;
+
+    // Среднее число названий в корзине
+    static constexpr size_t BUCKET_SIZE = 3;
+
+    // Функция получения номера ячейки таблицы для названия (название может в ней и не лежать)
+    size_t GetPosition(std::string_view name) const;
+
+    // Функция подбора смещений для названий (false, если подобрать не удалось)
+    bool BuildTable(const std::vector<Slot>& entries, const std::vector<uint64_t>& hashes);
+
+    // Функция перестроения, если изменений накопилось слишком много
+    void CompactIfNeeded();
+
+    std::vector<uint32_t> pilots_;            // Смещение каждой корзины
+    std::vector<Slot>     slots_;             // Ячейки таблицы (по одной на название)
+    uint64_t              seed_          = 0; // Затравка распределения по корзинам (меняется, если подобрать смещения не удалось)
+    size_t                removed_count_ = 0; // Число удалённых названий в таблице
+
+    std::unordered_map<std::string_view, uint32_t> added_; // Названия, которых нет в таблице (все, пока индекс не построен)
+};
+
+}
\ No newline at end of file
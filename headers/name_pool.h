@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Описатель названия в пуле: сквозное смещение от начала пула и длина
+struct NameHandle {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+// Пул названий остановок и маршрутов. Названия дописываются подряд в блоки, которые никогда не перемещаются,
+// поэтому string_view на названия стабильны, а отдельной памяти под каждое название не выделяется.
+// Смещения сквозные: содержимое пула, выписанное подряд (AppendTo), совпадает с тем, на что указывают описатели,
+// поэтому названия можно хранить компактными описателями и сохранять пул одним куском
+class NamePool {
+public:
+    NamePool() = default;
+
+    NamePool(NamePool&&) = default;
+    NamePool& operator = (NamePool&&) = default;
+
+    NamePool(const NamePool&) = delete;
+    NamePool& operator = (const NamePool&) = delete;
+
+    // Функция добавления названия в пул (возвращает стабильное представление добавленной копии)
+    std::string_view Add(std::string_view name);
+
+    // Функция резервирования места под size байт названий в текущем блоке
+    // (если известен суммарный размер названий, все они окажутся в одном непрерывном блоке)
+    void Reserve(size_t size);
+
+    // Функция получения описателя для названия, которое вернула функция Add
+    NameHandle GetHandle(std::string_view stored_name) const;
+
+    // Функция получения суммарного размера названий в пуле
+    size_t GetSize() const;
+
+    // Функция дописывания содержимого пула в строку out (смещения описателей отсчитываются от начала дописанного)
+    void AppendTo(std::string& out) const;
+
+private:
+    // Минимальный размер блока
+    static constexpr size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+    // Блок пула: названия в нём идут подряд и не пересекают границу блока
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t capacity = 0; // Размер блока
+        size_t size     = 0; // Занятая часть блока
+        size_t offset   = 0; // Сквозное смещение начала блока (сумма занятых частей предыдущих блоков)
+    };
+
+    // Функция добавления блока, в который поместится не меньше size байт
+    void AddBlock(size_t size);
+
+    std::vector<Block> blocks_;
+};
+
+}
\ No newline at end of file
@@ -3,8 +3,13 @@
 #include <vector>
 #include <string>
 #include <optional>
+#include <memory>
 #include "transport_catalogue.h"
 #include "map_renderer.h"
+#include "transport_router.h"
+#include "spatial_index.h"
+#include "serialization.h"
+#include "catalogue_image.h"
 
 // Пространство имён транспортного справочника
 namespace transport_catalogue {
@@ -26,6 +31,24 @@ struct AddBusRequest {
 	std::vector<std::string_view> stops; // Остановки на маршруте
 };
 
+// Структура запроса на задание расстояния между остановками
+struct SetDistanceRequest {
+	std::string_view from;     // Остановка, от которой задаётся расстояние
+	std::string_view to;       // Остановка, до которой задаётся расстояние
+	int              distance; // Расстояние в метрах
+};
+
+// Структура пакета изменений базы данных. Изменения применяются по группам в порядке объявления полей,
+// поэтому новые остановки можно сразу использовать в маршрутах, а остановки удалять вместе с проходившими через них маршрутами
+struct UpdateRequests {
+	std::vector<AddStopRequest>     update_stops;     // Добавляемые или изменяемые остановки (вместе с расстояниями)
+	std::vector<SetDistanceRequest> update_distances; // Задаваемые или изменяемые расстояния
+	std::vector<std::string_view>   remove_buses;     // Удаляемые маршруты
+	std::vector<AddBusRequest>      update_buses;     // Добавляемые или изменяемые маршруты
+	std::vector<std::pair<std::string_view, std::string_view>> remove_distances; // Удаляемые расстояния
+	std::vector<std::string_view>   remove_stops;     // Удаляемые остановки
+};
+
 // Класс обработчика запросов к транспортному справочнику
 class RequestHandler {
 public:
@@ -36,6 +59,29 @@ public:
     void SetData(const std::vector<AddStopRequest>& add_stop_requests,
                  const std::vector<AddBusRequest>&  add_bus_requests);
 
+    // Функция добавления остановки вместе с расстояниями до соседних остановок (для потоковой загрузки базы)
+    void AddStop(const AddStopRequest& add_stop_request);
+
+    // Функция добавления маршрута (для потоковой загрузки базы)
+    void AddBus(const AddBusRequest& add_bus_request);
+
+    // Функция задания настроек маршрутизации (граф маршрутов строится при завершении заполнения базы)
+    void SetRoutingSettings(const transport_router::RoutingSettings& settings);
+
+    // Функция завершения заполнения базы данных (после неё база замораживается и строится граф маршрутов)
+    void CompleteData();
+
+    // Функция изменения замороженной базы данных пакетом изменений. Пакет применяется целиком или не применяется вовсе
+    // (при ошибке применённые изменения откатываются, и исключение передаётся дальше). Справочник обновляется по частям,
+    // а в пространственном индексе и графе маршрутов пересчитываются только затронутые остановки
+    void UpdateData(const UpdateRequests& update_requests);
+
+    // Функция сохранения замороженной базы данных и настроек в бинарный файл (и в образ базы данных, если он задан)
+    void SaveBase(const serialization::SerializationSettings& serialization_settings, const serialization::BaseSettings& base_settings) const;
+
+    // Функция загрузки базы данных из бинарного файла в пустой справочник (после неё база заморожена и граф маршрутов построен)
+    serialization::BaseSettings LoadBase(const serialization::SerializationSettings& serialization_settings);
+
     // Функция получения информации об остановке
     std::optional<StopInfo> GetStopInfo(std::string_view name) const;
 
@@ -45,9 +91,21 @@ public:
     // Функция отрисовки карты маршрутов
     void RenderMap(const map_renderer::RenderSettings& settings, std::ostream& output = std::cout) const;
 
+    // Функция построения маршрута поездки между остановками (память route переиспользуется между вызовами).
+    // Возвращает false, если одной из остановок нет в базе, маршрута между ними не существует или не заданы настройки маршрутизации
+    bool BuildRoute(std::string_view from, std::string_view to, RouteInfo& route) const;
+
+    // Функция поиска остановок на расстоянии не более radius метров от точки center
+    // (результат упорядочен по расстоянию, память result переиспользуется между вызовами)
+    void FindStopsNearby(const geo::Coordinate& center, double radius, std::vector<NearbyStop>& result) const;
+
 private:
     TransportCatalogue& catalogue_;
     map_renderer::MapRenderer& renderer_;
+
+    std::optional<transport_router::RoutingSettings>   routing_settings_; // Настройки маршрутизации
+    std::unique_ptr<transport_router::TransportRouter> router_;           // Маршрутизатор (строится при завершении заполнения базы)
+    std::unique_ptr<spatial_index::SpatialIndex>       spatial_index_;    // Пространственный индекс остановок (строится при завершении заполнения базы)
 };
 
 }
@@ -0,0 +1,55 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <stdexcept>
+#include <cstdint>
+#include "transport_catalogue.h"
+#include "map_renderer.h"
+#include "transport_router.h"
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с сохранением базы данных справочника в бинарный файл
+namespace serialization {
+
+// Ошибка чтения бинарного файла базы данных (неверный формат, другая версия формата, обрезанный файл)
+class SerializationError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+// Версия формата бинарного файла (увеличивается при любом изменении формата)
+inline constexpr uint32_t FORMAT_VERSION = 2;
+
+// Структура настроек сериализации
+struct SerializationSettings {
+    std::string file;       // Путь к бинарному файлу базы данных
+    std::string image_file; // Путь к образу базы данных для чтения прямо из памяти (необязательный)
+};
+
+// Структура настроек, сохраняемых в бинарный файл вместе с базой данных
+struct BaseSettings {
+    std::optional<map_renderer::RenderSettings>     render_settings;  // Настройки отрисовки карты
+    std::optional<transport_router::RoutingSettings> routing_settings; // Настройки маршрутизации
+};
+
+// Функция сохранения замороженной базы данных и настроек в бинарный поток.
+// Формат: сигнатура, версия формата, затем остановки, маршруты, расстояния и настройки подряд
+void SaveBase(std::ostream& output, const TransportCatalogue& catalogue, const BaseSettings& settings);
+
+// Функция загрузки базы данных из бинарного буфера в пустой справочник (возвращает сохранённые настройки,
+// для непустого справочника - std::invalid_argument). После загрузки справочник нужно заморозить, как и после заполнения из JSON
+BaseSettings LoadBase(std::string_view input, TransportCatalogue& catalogue);
+
+// Функция сохранения базы данных и настроек в бинарный файл
+void SaveBaseToFile(const std::string& file, const TransportCatalogue& catalogue, const BaseSettings& settings);
+
+// Функция загрузки базы данных из бинарного файла (файл читается целиком одним последовательным чтением)
+BaseSettings LoadBaseFromFile(const std::string& file, TransportCatalogue& catalogue);
+
+}
+
+}
\ No newline at end of file
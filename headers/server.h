@@ -0,0 +1,82 @@
+#pragma once
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с работой справочника в режиме сервера
+namespace server {
+
+class ServerError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+// Буфер потока поверх файлового дескриптора (сокета): чтение и запись идут блоками через свои буферы.
+// Дескриптор закрывается в деструкторе
+class DescriptorStreamBuf : public std::streambuf {
+public:
+    explicit DescriptorStreamBuf(int descriptor);
+    ~DescriptorStreamBuf() override;
+
+    DescriptorStreamBuf(const DescriptorStreamBuf&) = delete;
+    DescriptorStreamBuf& operator = (const DescriptorStreamBuf&) = delete;
+
+    // Функция закрытия дескриптора на чтение: ожидающее чтение (в том числе в другом потоке) сразу получает конец потока
+    void ShutdownInput();
+
+protected:
+    int_type underflow() override;
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+private:
+    // Функция записи накопленного буфера вывода в дескриптор
+    bool FlushOutput();
+
+    int descriptor_;
+    char input_buffer_[1 << 16];
+    char output_buffer_[1 << 16];
+};
+
+// Обработчик одного соединения: читает запросы из input и пишет ответы в output.
+// close_input прерывает ожидание запросов от клиента (например, когда ответы ему уже не доходят)
+using Session = std::function<void(std::istream& input, std::ostream& output, const std::function<void()>& close_input)>;
+
+// Функция запуска сервера на Unix-сокете socket_path: каждое соединение обслуживается в своём потоке
+// функцией session. Функция не возвращает управление (кроме ошибки сокета; в этом случае все соединения
+// обрываются, и функция дожидается их потоков, прежде чем выбросить исключение)
+void ServeUnixSocket(const std::string& socket_path, const Session& session);
+
+// Структура обработчиков сигналов сервера (пустой обработчик - сигнал игнорируется)
+struct SignalHandlers {
+    std::function<void()> reload;       // SIGHUP: перезагрузка базы
+    std::function<void()> dump_metrics; // SIGUSR1: вывод накопленной статистики этапов обработки
+};
+
+// Класс потока, который вызывает обработчики при получении сигналов SIGHUP и SIGUSR1. Сигналы блокируются в потоке,
+// создающем объект, а потоки, созданные после этого, наследуют маску сигналов, поэтому объект нужно создать до создания
+// остальных потоков. Деструктор останавливает поток и дожидается его завершения, поэтому всё, к чему обращаются
+// обработчики, должно быть создано раньше объекта
+class SignalListener {
+public:
+    explicit SignalListener(SignalHandlers handlers);
+    ~SignalListener();
+
+    SignalListener(const SignalListener&) = delete;
+    SignalListener& operator = (const SignalListener&) = delete;
+
+private:
+    std::atomic<bool> stopped_{ false };
+    std::thread       thread_;
+};
+
+}
+
+}
\ No newline at end of file
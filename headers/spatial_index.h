@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "geo.h"
+#include "domain.h"
+#include "transport_catalogue.h"
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с пространственным поиском остановок
+namespace spatial_index {
+
+// Класс пространственного индекса остановок: равномерная сетка по широте и долготе.
+// Остановки каждой ячейки лежат в памяти подряд (в формате CSR) вместе со своими координатами,
+// поэтому при поиске просматриваются только ячейки, пересекающие описанный вокруг круга прямоугольник.
+// Изменённые после построения остановки не требуют перестроения: их места в сетке помечаются, а сами они
+// попадают в небольшой список, который просматривается целиком, пока его не выгодно разложить по сетке
+class SpatialIndex {
+public:
+    explicit SpatialIndex(const TransportCatalogue& catalogue);
+
+    // Функция обновления остановок stops после изменения справочника (новых, перемещённых или удалённых)
+    void Update(const std::vector<StopId>& stops);
+
+    // Функция поиска остановок на расстоянии не более radius метров от точки center.
+    // Результат упорядочен по расстоянию (при равенстве - по названию), память result переиспользуется
+    void FindStopsNearby(const geo::Coordinate& center, double radius, std::vector<NearbyStop>& result) const;
+
+private:
+    // Положение остановки, которой нет в индексе
+    static constexpr uint32_t NO_POSITION = UINT32_MAX;
+
+    // Признак положения в списке изменённых остановок (иначе положение - номер в сетке)
+    static constexpr uint32_t EXTRA_POSITION = 1u << 31;
+
+    // Функция построения сетки по всем остановкам справочника
+    void Build();
+
+    // Функция исключения остановки из индекса
+    void Erase(StopId id);
+
+    // Функция получения номера строки сетки по широте
+    uint32_t GetRow(double lat) const;
+
+    // Функция получения номера столбца сетки по долготе
+    uint32_t GetColumn(double lng) const;
+
+    const TransportCatalogue& catalogue_;
+
+    double min_lat_ = 0.0; // Границы сетки
+    double min_lng_ = 0.0;
+    double cell_lat_ = 1.0; // Размеры ячейки в градусах
+    double cell_lng_ = 1.0;
+    uint32_t rows_ = 1;     // Размеры сетки в ячейках
+    uint32_t columns_ = 1;
+
+    std::vector<uint32_t>        cell_offsets_; // Начало участка остановок каждой ячейки (размер - число ячеек + 1)
+    std::vector<StopId>          cell_stops_;   // Остановки всех ячеек подряд
+    std::vector<geo::Coordinate> cell_coordinates_; // Координаты остановок в том же порядке (у исключённых - бесконечная широта)
+    size_t                       removed_count_ = 0; // Число исключённых из сетки остановок
+
+    std::vector<StopId>          extra_stops_;       // Остановки, изменённые после построения сетки
+    std::vector<geo::Coordinate> extra_coordinates_; // Их координаты
+
+    std::vector<uint32_t>        positions_; // Положение каждой остановки в сетке или в списке изменённых (индекс - идентификатор остановки)
+};
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с многопоточной обработкой запросов
+namespace threading {
+
+// Класс пула потоков: потоки создаются один раз и выполняют задачи из общей очереди в порядке поступления.
+// Задачи можно добавлять одновременно из любого числа потоков
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads_count);
+
+    // Деструктор дожидается выполнения всех добавленных задач
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+
+    // Функция добавления задачи в очередь
+    void Submit(std::function<void()> task);
+
+    // Функция получения числа потоков пула
+    size_t GetThreadsCount() const;
+
+private:
+    // Функция потока пула: выполняет задачи, пока пул не остановлен и очередь не опустела
+    void Work();
+
+    std::mutex                        m_;
+    std::condition_variable           task_ready_;
+    std::deque<std::function<void()>> tasks_;           // Очередь задач
+    bool                              stopped_ = false; // Флаг остановки пула (выставляется в деструкторе)
+    std::vector<std::thread>          threads_;
+};
+
+}
+
+}
\ No newline at end of file
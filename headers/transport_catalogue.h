@@ -1,14 +1,15 @@
 #pragma once
 #include <string>
 #include <vector>
-#include <deque>
-#include <set>
-#include <map>
 #include <unordered_map>
 #include <optional>
+#include <cstdint>
+#include <limits>
 
 #include "geo.h"
 #include "domain.h"
+#include "name_pool.h"
+#include "name_index.h"
 
 // Пространство имён транспортного справочника
 namespace transport_catalogue {
@@ -16,17 +17,91 @@ namespace transport_catalogue {
 // Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue
 namespace detail {
 
-// Хешер для ключа pair<const Stop*, const Stop*> в unordered_map
-struct PairStopStopHasher {
-	size_t operator() (const std::pair<const Stop*, const Stop*>& stops) const;
+// Таблица дорожных расстояний между остановками в формате CSR (compressed sparse row):
+// для каждой остановки хранится непрерывный отсортированный по идентификатору участок соседей.
+// После построения CSR расстояния можно менять по одному: значения существующих пар меняются на месте,
+// удалённые пары помечаются, а новые попадают в небольшую хеш-таблицу, пока её не выгодно слить с CSR
+class DistancesTable {
+public:
+	// Функция задания расстояния от остановки from до остановки to (повторное задание перезаписывает значение)
+	void Set(StopId from, StopId to, int distance);
+
+	// Функция построения CSR-представления для stops_count остановок (расстояния в обратную сторону достраиваются здесь же)
+	void Build(size_t stops_count);
+
+	// Функция получения расстояния от остановки from до остановки to (если прямого нет, то берётся обратное)
+	std::optional<int> Get(StopId from, StopId to) const;
+
+	// Функция получения явно заданного расстояния от остановки from до остановки to (без подстановки обратного)
+	std::optional<int> GetExplicit(StopId from, StopId to) const;
+
+	// Функция получения явно заданных расстояний (после построения CSR - по одному на пару остановок, по порядку пар)
+	std::vector<RoadDistance> GetRecords() const;
+
+	// Функция изменения явно заданного расстояния от остановки from до остановки to (nullopt - удаление) без перестроения CSR.
+	// Расстояние в обратную сторону, если оно не задано явно, меняется вместе с прямым
+	void Update(StopId from, StopId to, std::optional<int> distance);
+
+	// Функция удаления всех расстояний от остановки и до неё
+	void Remove(StopId stop);
+
+private:
+	// Значение расстояния для пары остановок
+	struct Value {
+		int  distance;
+		bool is_explicit; // Расстояние задано явно, а не достроено по обратному
+	};
+
+	// Структура ребра: сосед и расстояние до него
+	struct Edge {
+		StopId to;
+		Value  value;
+	};
+
+	// Явно заданное расстояние (до построения CSR)
+	using Record = RoadDistance;
+
+	// Метка удалённого ребра CSR
+	static constexpr int NO_DISTANCE = std::numeric_limits<int>::min();
+
+	// Функция поиска явно заданного расстояния (используется, пока CSR не построено)
+	std::optional<int> FindRecord(StopId from, StopId to) const;
+
+	// Функция поиска ребра CSR (в том числе удалённого)
+	const Edge* FindEdge(StopId from, StopId to) const;
+
+	// Функция поиска значения расстояния после построения CSR (в CSR или среди добавленных позже)
+	const Value* FindValue(StopId from, StopId to) const;
+
+	// Функции изменения и удаления значения расстояния после построения CSR
+	void SetValue(StopId from, StopId to, Value value);
+	void EraseValue(StopId from, StopId to);
+
+	// Функция перестроения CSR, если изменений накопилось слишком много
+	void CompactIfNeeded();
+
+	// Функция получения ключа пары остановок
+	static uint64_t MakeKey(StopId from, StopId to);
+
+	std::vector<Record> records_; // Явно заданные расстояния (до построения CSR)
+
+	bool is_built_ = false;           // Флаг актуальности CSR-представления
+	size_t stops_count_ = 0;          // Число остановок, для которого построено CSR (с учётом остановок из изменений)
+	std::vector<uint32_t> offsets_;   // Начало участка соседей каждой остановки (размер - число остановок + 1)
+	std::vector<Edge>     edges_;     // Соседи всех остановок подряд
+
+	std::unordered_map<uint64_t, Value> added_; // Расстояния для пар, которых нет в CSR (заданные после его построения)
+	size_t removed_count_ = 0;                  // Число удалённых рёбер CSR
 };
 
 }
 
-// Класс транспортного справочника
+// Класс транспортного справочника.
+// Константные методы не изменяют состояние справочника (в том числе не заполняют никаких ленивых кэшей),
+// поэтому их можно одновременно вызывать из нескольких потоков, пока справочник не изменяется
 class TransportCatalogue {
 public:
-	// Функция добавления остановки в базу данных
+	// Функция добавления остановки в базу данных (маршруты и расстояния могут ссылаться на остановку до её добавления)
 	void AddStop(std::string_view name, const geo::Coordinate& coordinate);
 
 	// Функция добавления маршрута в базу данных
@@ -35,33 +110,132 @@ public:
 	// Функция добавления расстояния от остановки с именем stop_from до остановки с именем stop_to
 	void SetDistance(std::string_view stop_from, std::string_view stop_to, int distance);
 
-	// Функция получения константной ссылки на контейнер остановок (нужна для модуля map_renderer)
-	const std::deque<Stop>& GetStops() const;
+	// Функции изменения базы данных по частям. В отличие от функций добавления, они не сбрасывают заморозку:
+	// в замороженной базе сразу пересчитывается только затронутое (расстояния и статистика маршрутов,
+	// проходящих через изменённые остановки), поэтому время изменения пропорционально его размеру.
+	// Изменения, после которых замороженная база стала бы неполной, отклоняются с std::invalid_argument
+
+	// Функция добавления остановки или изменения её координат
+	void UpdateStop(std::string_view name, const geo::Coordinate& coordinate);
+
+	// Функция удаления остановки вместе с расстояниями от неё и до неё (через остановку не должны проходить маршруты).
+	// Возвращает false, если остановки нет в базе
+	bool RemoveStop(std::string_view name);
+
+	// Функция добавления маршрута или замены его остановок и типа
+	void UpdateBus(std::string_view name, BusRouteType type, const std::vector<std::string_view>& stops);
+
+	// Функция удаления маршрута. Возвращает false, если маршрута нет в базе
+	bool RemoveBus(std::string_view name);
+
+	// Функция задания или изменения расстояния от остановки с именем stop_from до остановки с именем stop_to
+	void UpdateDistance(std::string_view stop_from, std::string_view stop_to, int distance);
 
-	// Функция получения словаря "Имя остановки" -> "Константный указатель на остановку в базе данных" (нужна для модуля map_renderer)
-	const std::map<std::string_view, const Stop*> GetStopnameToStopMap() const;
+	// Функция удаления явно заданного расстояния от остановки с именем stop_from до остановки с именем stop_to
+	// (если задано обратное, оно начинает действовать в обе стороны). Возвращает false, если расстояние не было задано
+	bool RemoveDistance(std::string_view stop_from, std::string_view stop_to);
 
-	// Функция получения словаря "Имя маршрута" -> "Константный указатель на маршрут в базе данных" (нужна для модуля map_renderer)
-	const std::map<std::string_view, const Bus*> GetBusnameToBusMap() const;
+	// Функция получения константной ссылки на контейнер остановок (нужна для модуля map_renderer).
+	// Удалённые остановки остаются в контейнере, чтобы не менялись идентификаторы остальных (см. IsStopRemoved)
+	const std::vector<Stop>& GetStops() const;
+
+	// Функция проверки, что остановка с данным идентификатором удалена из базы
+	bool IsStopRemoved(StopId id) const;
+
+	// Функция получения константной ссылки на контейнер маршрутов
+	const std::vector<Bus>& GetBuses() const;
+
+	// Функция получения пула названий остановок и маршрутов (названия в Stop и Bus указывают в него, нужна для модуля serialization)
+	const NamePool& GetNamePool() const;
+
+	// Функция резервирования места под size байт названий (если суммарный размер названий известен заранее,
+	// например при загрузке из бинарного файла, все названия окажутся в одном непрерывном блоке)
+	void ReserveNames(size_t size);
+
+	// Функция получения остановки по её идентификатору
+	const Stop& GetStop(StopId id) const;
+
+	// Функция получения маршрута по его идентификатору
+	const Bus& GetBus(BusId id) const;
+
+	// Функция поиска идентификатора остановки по её названию
+	std::optional<StopId> FindStopId(std::string_view name) const;
+
+	// Функция поиска идентификатора маршрута по его названию
+	std::optional<BusId> FindBusId(std::string_view name) const;
+
+	// Функция получения дорожного расстояния между остановками (если прямого нет, то берётся обратное)
+	std::optional<int> GetDistance(StopId from, StopId to) const;
+
+	// Функция получения явно заданного дорожного расстояния между остановками (без подстановки обратного)
+	std::optional<int> GetExplicitDistance(StopId from, StopId to) const;
+
+	// Функция получения явно заданных дорожных расстояний (после заморозки - по одному на пару остановок, нужна для модуля serialization)
+	std::vector<RoadDistance> GetRoadDistances() const;
 
 	// Функция наличия маршрутов на остановке
 	bool IfBusesOnStop(std:: string_view name) const;
-	
+
+	// Функция наличия маршрутов на остановке по её идентификатору
+	bool IfBusesOnStop(StopId id) const;
+
 	// Функция получения информации об остановке
 	std::optional<StopInfo> GetStopInfo(std::string_view name) const;
 
 	// Функция получения информации о маршруте
 	std::optional<BusInfo> GetBusInfo(std::string_view name) const;
 
+	// Функция заморозки базы данных: однократный расчёт статистики всех маршрутов после заполнения базы
+	// и построение индексов названий, в которых поиск - одно обращение к таблице
+	void Freeze();
+
+	// Функция получения номера версии базы данных (увеличивается при каждом изменении базы, нужна для инвалидации кэшей)
+	uint64_t GetVersion() const;
+
 private:
-	std::deque<Stop> stops_; // Остановки
-	std::deque<Bus>  buses_; // Маршруты
+	// Состояние остановки
+	enum class StopState : uint8_t {
+		Referenced, // Остановка только упомянута в маршруте или расстоянии
+		Defined,    // Остановка добавлена
+		Removed     // Остановка удалена (её идентификатор больше не используется)
+	};
+
+	// Функция получения идентификатора остановки по названию (если остановки ещё нет, под неё резервируется идентификатор)
+	StopId InternStop(std::string_view name);
+
+	// Функция получения идентификатора добавленной остановки для изменения замороженной базы (иначе std::invalid_argument)
+	StopId GetDefinedStopId(std::string_view name) const;
+
+	// Функция проверки, что между соседними остановками маршрута заданы расстояния (иначе std::invalid_argument)
+	void CheckBusDistances(std::string_view name, const std::vector<StopId>& stops) const;
+
+	// Функция пересчёта статистики маршрутов, проходящих через остановку (для замороженной базы)
+	void UpdateBusesInfo(StopId stop);
+
+	// Функция расчёта географической длины маршрута в одну сторону (по одному расстоянию за вызов, для незамороженной базы)
+	double ComputePathLength(const Bus& bus) const;
+
+	// Функция расчёта статистики маршрута (длина, извилистость, число остановок) по его географической длине в одну сторону
+	BusInfo ComputeBusInfo(const Bus& bus, double path_length) const;
+
+	// Функция сброса заморозки базы данных (вызывается при любом изменении базы)
+	void Unfreeze();
+
+	NamePool names_; // Названия остановок и маршрутов (пул не перемещает названия, поэтому string_view на них стабильны)
+
+	std::vector<Stop> stops_; // Остановки (индекс в векторе - идентификатор остановки)
+	std::vector<StopState> stops_state_; // Состояния остановок (индекс - идентификатор остановки)
+	std::vector<Bus>  buses_; // Маршруты  (индекс в векторе - идентификатор маршрута)
+
+	NameIndex stopname_to_id_; // Индекс "Имя остановки" -> "Идентификатор остановки" (при заморозке строится совершенная хеш-функция)
+	NameIndex busname_to_id_;  // Индекс "Имя маршрута"  -> "Идентификатор маршрута"
 
-	std::map<std::string_view, Stop*> stopname_to_stop_; // Словарь "Имя остановки" -> "Указатель на остановку в базе данных"
-	std::map<std::string_view, Bus*>  busname_to_bus_;   // Словарь "Имя маршрута"  -> "Указатель на маршрут в базе данных"
+	detail::DistancesTable distances_; // Расстояния между остановками
 
-	std::unordered_map<std::pair<const Stop*, const Stop*>, int, detail::PairStopStopHasher> distances_; // Расстояния между остановками
+	std::vector<std::vector<std::string_view>> buses_on_stop_; // Маршруты, проходящие через остановку (упорядоченные по алфавиту названия без повторов; индекс - идентификатор остановки)
 
-	std::unordered_map<const Stop*, std::set<std::string_view>> buses_on_stop_; // Маршруты, проходящие через остановку (названия, упорядоченные по алфавиту)
+	uint64_t version_ = 0;            // Номер версии базы данных
+	bool is_frozen_ = false;          // Флаг заморозки базы данных
+	std::vector<BusInfo> buses_info_; // Таблица статистики маршрутов (индекс - идентификатор маршрута, заполняется при заморозке)
 };
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <optional>
+#include "transport_catalogue.h"
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с построением маршрутов поездок
+namespace transport_router {
+
+// Структура настроек маршрутизации
+struct RoutingSettings {
+    int    bus_wait_time; // Время ожидания автобуса на остановке в минутах
+    double bus_velocity;  // Скорость автобуса в км/ч
+};
+
+// Класс маршрутизатора поездок по транспортному справочнику.
+// Граф строится в конструкторе: вершины - остановки, рёбра - поездки на одном автобусе
+// между любыми двумя остановками его маршрута (вес - ожидание автобуса плюс время в пути).
+// После изменения справочника пересчитываются только рёбра из затронутых остановок.
+// Поиск маршрута - алгоритм Дейкстры на рабочих массивах, которые хранятся в каждом потоке
+// и переиспользуются между запросами, поэтому после первого запроса память не выделяется
+class TransportRouter {
+public:
+    TransportRouter(const TransportCatalogue& catalogue, const RoutingSettings& settings);
+
+    // Функция пересчёта рёбер, выходящих из остановок stops (после изменения проходящих через них маршрутов
+    // или расстояний между остановками этих маршрутов). Новые остановки справочника добавляются в граф
+    void Update(std::vector<StopId> stops);
+
+    // Функция построения маршрута поездки между остановками. Результат записывается в route
+    // (его память переиспользуется), возвращается false, если маршрута не существует
+    bool BuildRoute(StopId from, StopId to, RouteInfo& route) const;
+
+    // Функция получения настроек маршрутизации
+    const RoutingSettings& GetSettings() const;
+
+private:
+    // Структура ребра графа: поездка на одном автобусе через span_count остановок
+    struct Edge {
+        StopId   to;         // Остановка, в которую ведёт ребро
+        BusId    bus;        // Автобус
+        uint32_t span_count; // Число проезжаемых остановок
+        double   weight;     // Время ожидания автобуса и поездки в минутах
+        double   ride_time;  // Время поездки в минутах (без ожидания)
+    };
+
+    // Участок рёбер остановки
+    struct EdgesRange {
+        uint32_t begin = 0;
+        uint32_t end   = 0;
+    };
+
+    // Функция добавления в граф рёбер для последовательности остановок, проезжаемых автобусом в одном направлении
+    // (если задана остановка only_from - только рёбер из неё)
+    void AddBusEdges(std::vector<std::pair<StopId, Edge>>& edges, BusId bus, const std::vector<StopId>& stops, bool reversed,
+                     std::optional<StopId> only_from = std::nullopt) const;
+
+    // Функция замены рёбер графа отсортированными рёбрами edges: из параллельных остаётся самое быстрое,
+    // а участки остановок из edges дописываются в конец edges_
+    void AppendEdges(std::vector<std::pair<StopId, Edge>>& edges);
+
+    // Функция перестроения edges_ без устаревших участков, если их накопилось слишком много
+    void CompactIfNeeded();
+
+    const TransportCatalogue& catalogue_;
+    RoutingSettings settings_;
+
+    std::vector<EdgesRange> ranges_;          // Участок рёбер каждой остановки в edges_
+    std::vector<Edge>       edges_;           // Рёбра (после изменений - вместе с устаревшими участками)
+    size_t                  stale_edges_ = 0; // Число рёбер в устаревших участках
+};
+
+}
+
+}
\ No newline at end of file
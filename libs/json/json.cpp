@@ -1,5 +1,17 @@
+#include <algorithm>
 #include <array>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <utility>
 #include "json.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 using namespace std;
 
 namespace json {
@@ -395,115 +407,821 @@ Document::Document(istream& input) : Document(detail::LoadNode(input)) { }
 
 namespace detail {
 
-struct PrintContext {
-	ostream& out;
-	size_t indent_step = 4u;
-	size_t indent = 0u;
-	string prefix = ""s;
+// Однопроходный парсер JSON поверх непрерывного буфера: вместо посимвольного чтения
+// из потока просто двигает указатель по буферу, числа разбирает при помощи from_chars
+class BufferParser {
+public:
+	explicit BufferParser(string_view buffer) : pos_(buffer.data()), end_(buffer.data() + buffer.size()) { }
+
+	// Функция пропуска пробельных символов и получения очередного символа (или '\0' в конце буфера)
+	char PeekFirstNonSpaceChar() {
+		while (pos_ != end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r')) ++pos_;
+		return pos_ != end_ ? *pos_ : '\0';
+	}
+
+	// Функция разбора строки. Если в строке нет escape-последовательностей, возвращается
+	// представление прямо в исходный буфер, иначе - в раскодированную копию (до следующего вызова)
+	string_view ReadString() {
+		if (pos_ == end_ || *pos_ != '\"') throw ParsingError("String parsing error"s);
+		++pos_;
+
+		const char* begin = pos_;
+
+		// Быстрый путь: ищем закрывающую кавычку, пока не встретили escape-последовательность
+		while (pos_ != end_ && *pos_ != '\"' && *pos_ != '\\') {
+			if (*pos_ == '\n' || *pos_ == '\r') throw ParsingError("Unexpected end of line"s);
+			++pos_;
+		}
+
+		if (pos_ == end_) throw ParsingError("String parsing error"s);
+
+		if (*pos_ == '\"') {
+			++pos_;
+			return string_view(begin, pos_ - begin - 1);
+		}
+
+		// Медленный путь: строка содержит escape-последовательности, раскодируем её в escaped_
+		escaped_.assign(begin, pos_);
+
+		while (true) {
+			// Буфер закончился до того, как встретили закрывающую кавычку?
+			if (pos_ == end_) throw ParsingError("String parsing error"s);
+
+			const char ch = *pos_++;
+
+			// Встретили закрывающую кавычку
+			if (ch == '\"') break;
+
+			// Встретили начало escape-последовательности
+			else if (ch == '\\') {
+
+				// Буфер завершился сразу после символа обратной косой черты
+				if (pos_ == end_) throw ParsingError("String parsing error"s);
+
+				const char escaped_char = *pos_++;
+
+				// Обрабатываем одну из последовательностей: \\, \n, \t, \r, \"
+				switch (escaped_char) {
+					case 'n':  escaped_.push_back('\n'); break;
+					case 't':  escaped_.push_back('\t'); break;
+					case 'r':  escaped_.push_back('\r'); break;
+					case '\"': escaped_.push_back('\"'); break;
+					case '\\': escaped_.push_back('\\'); break;
+
+					// Встретили неизвестную escape-последовательность
+					default: throw ParsingError("Unrecognized escape sequence \\"s + escaped_char); break;
+				}
+			}
+
+			// Строковый литерал внутри JSON не может прерываться символами \r или \n
+			else if (ch == '\n' || ch == '\r') throw ParsingError("Unexpected end of line"s);
+
+			// Просто помещаем очередной символ в результирующую строку
+			else escaped_.push_back(ch);
+		}
+
+		return escaped_;
+	}
+
+	// Функция разбора числа (int, если оно целое и помещается в int, иначе double)
+	variant<int, double> ReadNumber() {
+		const char* begin = pos_;
+
+		// Пропускает одну или более цифр
+		auto skip_digits = [this] {
+			if (pos_ == end_ || !isdigit(static_cast<unsigned char>(*pos_))) throw ParsingError("A digit is expected"s);
+			while (pos_ != end_ && isdigit(static_cast<unsigned char>(*pos_))) ++pos_;
+		};
+
+		if (pos_ != end_ && *pos_ == '-') ++pos_;
+
+		// Парсим целую часть числа
+		// После 0 в JSON не могут идти другие цифры
+		if (pos_ != end_ && *pos_ == '0') ++pos_;
+		else skip_digits();
+
+		bool is_int = true;
+
+		// Парсим дробную часть числа
+		if (pos_ != end_ && *pos_ == '.') {
+			++pos_;
+			skip_digits();
+			is_int = false;
+		}
+
+		// Парсим экспоненциальную часть числа
+		if (pos_ != end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+			++pos_;
+			if (pos_ != end_ && (*pos_ == '+' || *pos_ == '-')) ++pos_;
+			skip_digits();
+			is_int = false;
+		}
+
+		if (is_int) {
+			// Сначала пробуем преобразовать строку в int,
+			// в случае неудачи (при переполнении) код ниже преобразует строку в double
+			int value = 0;
+			if (const auto [ptr, ec] = from_chars(begin, pos_, value); ec == errc() && ptr == pos_) {
+				return value;
+			}
+		}
+
+		double value = 0.0;
+		if (const auto [ptr, ec] = from_chars(begin, pos_, value); ec != errc() || ptr != pos_) {
+			throw ParsingError("Failed to convert "s + string(begin, pos_) + " to number"s);
+		}
+
+		return value;
+	}
+
+	// Функция разбора литерала (null, true или false)
+	void ReadLiteral(string_view literal) {
+		if (static_cast<size_t>(end_ - pos_) < literal.size() || string_view(pos_, literal.size()) != literal) {
+			throw ParsingError("Literal parsing error, expected "s + string(literal));
+		}
+		pos_ += literal.size();
+	}
+
+	// Функция разбора массива
+	Node ReadArray() {
+		++pos_;
+
+		Array result;
+
+		if (PeekFirstNonSpaceChar() == ']') { ++pos_; return Node(move(result)); }
+
+		while (true) {
+			result.push_back(ReadNode());
+
+			const char ch = PeekFirstNonSpaceChar();
+
+			if      (ch == ',') { ++pos_; }
+			else if (ch == ']') { ++pos_; break; }
+			else if (ch == '\0') throw ParsingError("Scope \"[\" in the array is not closed"s);
+			else                 throw ParsingError("Comma expected after value in array"s);
+
+			if (PeekFirstNonSpaceChar() == ']') throw ParsingError("Expected value after comma before scope \"]\" in array"s);
+		}
+
+		return Node(move(result));
+	}
+
+	// Функция разбора словаря
+	Node ReadDict() {
+		++pos_;
+
+		Dict result;
+
+		if (PeekFirstNonSpaceChar() == '}') { ++pos_; return Node(move(result)); }
+
+		while (true) {
+			if (PeekFirstNonSpaceChar() != '\"') throw ParsingError("Expected key in dictionary"s);
+			string key(ReadString());
+
+			if (PeekFirstNonSpaceChar() != ':') throw ParsingError("Expected colon after key in dictionary"s);
+			++pos_;
+
+			if (PeekFirstNonSpaceChar() == '}') throw ParsingError("Expected value after colon before scope \"}\" in dictionary"s);
+			result.emplace(move(key), ReadNode());
+
+			const char ch = PeekFirstNonSpaceChar();
+
+			if      (ch == ',') { ++pos_; }
+			else if (ch == '}') { ++pos_; break; }
+			else if (ch == '\0') throw ParsingError("Scope \"{\" in the dictionary is not closed"s);
+			else                 throw ParsingError("Expected comma or scope \"}\" after key-value pair in dictionary"s);
+		}
+
+		return Node(move(result));
+	}
 
-	void PrintIndentWithPrefix() const {
-		for (size_t i = 0; i < indent; ++i) out.put(' ');
-		out << prefix;
+	// Функция разбора произвольного значения
+	Node ReadNode() {
+		switch (PeekFirstNonSpaceChar()) {
+			case '[':  return ReadArray();
+			case '{':  return ReadDict();
+			case '\"': return Node(string(ReadString()));
+			case 'n':  ReadLiteral("null"sv);  return Node(nullptr);
+			case 't':  ReadLiteral("true"sv);  return Node(true);
+			case 'f':  ReadLiteral("false"sv); return Node(false);
+			case '\0': throw ParsingError("Unexpected end of input"s);
+			default:   return visit([](auto value) { return Node(value); }, ReadNumber());
+		}
 	}
 
-	void PrintIndentWithSpacedPrefix() const {
-		for (size_t i = 0; i < indent + prefix.size(); ++i) out.put(' ');
+	// Функция разбора произвольного значения с передачей событий обработчику (без построения DOM)
+	void ReadEvents(SaxHandler& handler) {
+		switch (PeekFirstNonSpaceChar()) {
+			case '[':  ReadArrayEvents(handler); break;
+			case '{':  ReadDictEvents(handler);  break;
+			case '\"': handler.String(ReadString()); break;
+			case 'n':  ReadLiteral("null"sv);  handler.Null();      break;
+			case 't':  ReadLiteral("true"sv);  handler.Bool(true);  break;
+			case 'f':  ReadLiteral("false"sv); handler.Bool(false); break;
+			case '\0': throw ParsingError("Unexpected end of input"s);
+			default:
+				visit([&handler](auto value) {
+					if constexpr (is_same_v<decltype(value), int>) handler.Int(value);
+					else                                           handler.Double(value);
+				}, ReadNumber());
+				break;
+		}
 	}
 
-	PrintContext Indented() const {
-		return { out, indent_step, indent + indent_step + prefix.size()};
+private:
+	// Функция разбора массива с передачей событий обработчику
+	void ReadArrayEvents(SaxHandler& handler) {
+		++pos_;
+		handler.StartArray();
+
+		if (PeekFirstNonSpaceChar() == ']') { ++pos_; handler.EndArray(); return; }
+
+		while (true) {
+			ReadEvents(handler);
+
+			const char ch = PeekFirstNonSpaceChar();
+
+			if      (ch == ',') { ++pos_; }
+			else if (ch == ']') { ++pos_; break; }
+			else if (ch == '\0') throw ParsingError("Scope \"[\" in the array is not closed"s);
+			else                 throw ParsingError("Comma expected after value in array"s);
+
+			if (PeekFirstNonSpaceChar() == ']') throw ParsingError("Expected value after comma before scope \"]\" in array"s);
+		}
+
+		handler.EndArray();
 	}
 
-	PrintContext Indented(const string& new_prefix) const {
-		return { out, indent_step, indent + indent_step + prefix.size(), new_prefix};
+	// Функция разбора словаря с передачей событий обработчику
+	void ReadDictEvents(SaxHandler& handler) {
+		++pos_;
+		handler.StartDict();
+
+		if (PeekFirstNonSpaceChar() == '}') { ++pos_; handler.EndDict(); return; }
+
+		while (true) {
+			if (PeekFirstNonSpaceChar() != '\"') throw ParsingError("Expected key in dictionary"s);
+			handler.Key(ReadString());
+
+			if (PeekFirstNonSpaceChar() != ':') throw ParsingError("Expected colon after key in dictionary"s);
+			++pos_;
+
+			if (PeekFirstNonSpaceChar() == '}') throw ParsingError("Expected value after colon before scope \"}\" in dictionary"s);
+			ReadEvents(handler);
+
+			const char ch = PeekFirstNonSpaceChar();
+
+			if      (ch == ',') { ++pos_; }
+			else if (ch == '}') { ++pos_; break; }
+			else if (ch == '\0') throw ParsingError("Scope \"{\" in the dictionary is not closed"s);
+			else                 throw ParsingError("Expected comma or scope \"}\" after key-value pair in dictionary"s);
+		}
+
+		handler.EndDict();
 	}
+
+	const char* pos_; // Текущая позиция в буфере
+	const char* end_; // Конец буфера
+
+	string escaped_; // Буфер для строк с escape-последовательностями
 };
 
-void PrintNode(const Node& node, PrintContext ctx);
+}
+
+// Функция загрузки документа из непрерывного буфера (однопроходный разбор без потоков)
+Document Load(string_view buffer) {
+	return Document(detail::BufferParser(buffer).ReadNode());
+}
+
+// Функция потокового (SAX) разбора непрерывного буфера: вместо построения DOM события передаются обработчику
+void ParseSax(string_view buffer, SaxHandler& handler) {
+	detail::BufferParser(buffer).ReadEvents(handler);
+}
+
+Arena::Arena(Arena&& other) noexcept : blocks_(move(other.blocks_)),
+                                        pos_(exchange(other.pos_, nullptr)),
+                                        end_(exchange(other.end_, nullptr)) { }
 
-struct NodePrinter {
+Arena& Arena::operator = (Arena&& other) noexcept {
+	blocks_ = move(other.blocks_);
+	pos_ = exchange(other.pos_, nullptr);
+	end_ = exchange(other.end_, nullptr);
+	return *this;
+}
+
+void* Arena::Allocate(size_t size, size_t align) {
+	// Отступ до ближайшего выровненного адреса в текущем блоке
+	size_t padding = pos_ ? (align - reinterpret_cast<uintptr_t>(pos_) % align) % align : 0u;
 
-	const PrintContext& ctx;
+	if (!pos_ || static_cast<size_t>(end_ - pos_) < padding + size) {
+		// Каждый следующий блок вдвое больше предыдущего, поэтому число блоков растёт логарифмически
+		const size_t block_size = max({ MIN_BLOCK_SIZE, blocks_.empty() ? size_t(0) : blocks_.back().size * 2u, size + align });
 
-	void operator() (nullptr_t) {
-		ctx.PrintIndentWithPrefix();
-		ctx.out << "null"sv;
+		blocks_.push_back(Block{ make_unique<char[]>(block_size), block_size });
+		pos_ = blocks_.back().data.get();
+		end_ = pos_ + block_size;
+
+		padding = (align - reinterpret_cast<uintptr_t>(pos_) % align) % align;
 	}
 
-	void operator() (const Array& array) {
-		ctx.PrintIndentWithPrefix();
-		ctx.out << "["sv << endl;
+	char* result = pos_ + padding;
+	pos_ = result + size;
+	return result;
+}
 
-    	bool first = true;
-    	for (const Node& node : array) {
-        	if (!first) ctx.out << ","sv << endl;
-        	else        first = false;
+string_view Arena::CopyString(string_view str) {
+	if (str.empty()) return {};
 
-			PrintNode(node, ctx.Indented());
-    	}
+	char* data = AllocateArray<char>(str.size());
+	copy(str.begin(), str.end(), data);
+	return { data, str.size() };
+}
+
+void Arena::Reset() {
+	if (blocks_.empty()) return;
 
-		ctx.out << endl;
-		ctx.PrintIndentWithSpacedPrefix();
-		ctx.out << "]"sv;
+	// Последний блок самый большой: его хватит на следующий документ того же размера
+	if (blocks_.size() > 1) {
+		Block last = move(blocks_.back());
+		blocks_.clear();
+		blocks_.push_back(move(last));
 	}
 
-	void operator() (const Dict& map) {
-		ctx.PrintIndentWithPrefix();
-		ctx.out << "{"sv << endl;
+	pos_ = blocks_.back().data.get();
+	end_ = pos_ + blocks_.back().size;
+}
+
+ArenaNode::ArenaNode() : int_(0) { }
+
+bool ArenaNode::IsNull()       const { return type_ == Type::Null;   }
+bool ArenaNode::IsArray()      const { return type_ == Type::Array;  }
+bool ArenaNode::IsMap()        const { return type_ == Type::Map;    }
+bool ArenaNode::IsBool()       const { return type_ == Type::Bool;   }
+bool ArenaNode::IsInt()        const { return type_ == Type::Int;    }
+bool ArenaNode::IsDouble()     const { return type_ == Type::Double || type_ == Type::Int; }
+bool ArenaNode::IsPureDouble() const { return type_ == Type::Double; }
+bool ArenaNode::IsString()     const { return type_ == Type::String; }
+
+ArenaArray ArenaNode::AsArray() const {
+	if (!IsArray()) throw logic_error("Node is not an Array"s);
+	return { items_, size_ };
+}
+
+ArenaDict ArenaNode::AsMap() const {
+	if (!IsMap()) throw logic_error("Node is not a Map"s);
+	return { members_, size_ };
+}
 
-    	bool first = true;
-    	for (const auto& [key, value] : map) {
-        	if (!first) ctx.out << ", "sv << endl;
-        	else        first = false;
+bool ArenaNode::AsBool() const {
+	if (!IsBool()) throw logic_error("Node is not a Bool"s);
+	return bool_;
+}
 
-			const string key_prefix = "\""s + key + "\": "s;
-			PrintNode(value, ctx.Indented(key_prefix));
-    	}
+int ArenaNode::AsInt() const {
+	if (!IsInt()) throw logic_error("Node is not an Int"s);
+	return int_;
+}
 
-		ctx.out << endl;
-		ctx.PrintIndentWithSpacedPrefix();
-		ctx.out << "}"sv;
+double ArenaNode::AsDouble() const {
+	if (!IsDouble()) throw logic_error("Node is not a Double (and not is Int)"s);
+	return IsInt() ? static_cast<double>(int_) : double_;
+}
+
+string_view ArenaNode::AsString() const {
+	if (!IsString()) throw logic_error("Node is not a String"s);
+	return { string_, size_ };
+}
+
+const ArenaMember* ArenaDict::find(string_view key) const {
+	const ArenaMember* it = lower_bound(begin(), end(), key, [](const ArenaMember& member, string_view key) { return member.key < key; });
+	return it != end() && it->key == key ? it : end();
+}
+
+const ArenaNode& ArenaDict::at(string_view key) const {
+	const ArenaMember* it = find(key);
+	if (it == end()) throw out_of_range("Key \""s + string(key) + "\" is not found in the dictionary"s);
+	return it->value;
+}
+
+ArenaBuilder::ArenaBuilder(Arena& arena) : arena_(arena) { }
+
+void ArenaBuilder::Null() {
+	AddValue(TakeKey(), ArenaNode());
+}
+
+void ArenaBuilder::Bool(bool value) {
+	ArenaNode node;
+	node.type_ = ArenaNode::Type::Bool;
+	node.bool_ = value;
+	AddValue(TakeKey(), node);
+}
+
+void ArenaBuilder::Int(int value) {
+	ArenaNode node;
+	node.type_ = ArenaNode::Type::Int;
+	node.int_  = value;
+	AddValue(TakeKey(), node);
+}
+
+void ArenaBuilder::Double(double value) {
+	ArenaNode node;
+	node.type_   = ArenaNode::Type::Double;
+	node.double_ = value;
+	AddValue(TakeKey(), node);
+}
+
+void ArenaBuilder::String(string_view value) {
+	ArenaNode node;
+	node.type_   = ArenaNode::Type::String;
+	node.string_ = arena_.CopyString(value).data();
+	node.size_   = static_cast<uint32_t>(value.size());
+	AddValue(TakeKey(), node);
+}
+
+void ArenaBuilder::StartArray() {
+	const string_view key = TakeKey();
+	containers_.push_back({ false, items_.size(), key });
+}
+
+void ArenaBuilder::EndArray() {
+	if (containers_.empty() || containers_.back().is_dict) throw ParsingError("Unexpected end of array"s);
+
+	const Container array = containers_.back();
+	containers_.pop_back();
+
+	const size_t count = items_.size() - array.begin;
+
+	ArenaNode* items = arena_.AllocateArray<ArenaNode>(count);
+	uninitialized_copy(items_.begin() + array.begin, items_.end(), items);
+	items_.resize(array.begin);
+
+	ArenaNode node;
+	node.type_  = ArenaNode::Type::Array;
+	node.items_ = items;
+	node.size_  = static_cast<uint32_t>(count);
+	AddValue(array.key, node);
+}
+
+void ArenaBuilder::StartDict() {
+	const string_view key = TakeKey();
+	containers_.push_back({ true, members_.size(), key });
+}
+
+void ArenaBuilder::Key(string_view key) {
+	if (containers_.empty() || !containers_.back().is_dict) throw ParsingError("Unexpected key outside of dictionary"s);
+	key_ = arena_.CopyString(key);
+}
+
+void ArenaBuilder::EndDict() {
+	if (containers_.empty() || !containers_.back().is_dict) throw ParsingError("Unexpected end of dictionary"s);
+
+	const Container dict = containers_.back();
+	containers_.pop_back();
+
+	// Упорядочиваем элементы по ключу, а из повторяющихся ключей оставляем первый
+	const auto first = members_.begin() + dict.begin;
+	sort(first, members_.end(), [](const PendingMember& lhs, const PendingMember& rhs) {
+		return lhs.key != rhs.key ? lhs.key < rhs.key : lhs.order < rhs.order;
+	});
+	const auto last = unique(first, members_.end(), [](const PendingMember& lhs, const PendingMember& rhs) {
+		return lhs.key == rhs.key;
+	});
+
+	const size_t count = static_cast<size_t>(last - first);
+
+	ArenaMember* members = arena_.AllocateArray<ArenaMember>(count);
+	for (size_t i = 0; i < count; ++i) {
+		new (members + i) ArenaMember{ first[i].key, first[i].value };
 	}
+	members_.resize(dict.begin);
+
+	ArenaNode node;
+	node.type_    = ArenaNode::Type::Map;
+	node.members_ = members;
+	node.size_    = static_cast<uint32_t>(count);
+	AddValue(dict.key, node);
+}
+
+bool ArenaBuilder::IsComplete() const {
+	return root_.has_value();
+}
+
+ArenaNode ArenaBuilder::Extract() {
+	if (!root_) throw logic_error("Node is not complete"s);
+
+	const ArenaNode result = *root_;
+	root_.reset();
+	return result;
+}
 
-	void operator() (bool value) {
-		ctx.PrintIndentWithPrefix();
-		ctx.out << (value ? "true"sv : "false"sv);
+// Функция получения ключа, под которым очередное значение попадёт в открытый словарь (вне словаря ключ пуст)
+string_view ArenaBuilder::TakeKey() {
+	if (containers_.empty() || !containers_.back().is_dict) return {};
+	if (!key_) throw ParsingError("Value without key in dictionary"s);
+
+	const string_view key = *key_;
+	key_.reset();
+	return key;
+}
+
+void ArenaBuilder::AddValue(string_view key, const ArenaNode& value) {
+	if (containers_.empty()) {
+		if (root_) throw ParsingError("Value after complete node"s);
+		root_ = value;
+	}
+	else if (containers_.back().is_dict) {
+		members_.push_back({ key, value, members_.size() - containers_.back().begin });
 	}
+	else {
+		items_.push_back(value);
+	}
+}
+
+ArenaDocument::ArenaDocument(string_view buffer) {
+	ArenaBuilder builder(arena_);
+	ParseSax(buffer, builder);
+	root_ = builder.Extract();
+}
+
+const ArenaNode& ArenaDocument::GetRoot() const {
+	return root_;
+}
+
+#ifdef _WIN32
+
+// На Windows файл просто целиком читается в память
+MappedFile::MappedFile(const string& path) {
+	ifstream input(path, ios::binary);
+	if (!input) throw runtime_error("Failed to open file \""s + path + "\""s);
 
-	void operator() (int value) {
-		ctx.PrintIndentWithPrefix();
-		ctx.out << value;
+	content_.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+	data_ = content_;
+}
+
+MappedFile::~MappedFile() = default;
+
+#else
+
+// На POSIX-системах файл отображается в память только для чтения
+MappedFile::MappedFile(const string& path) {
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw runtime_error("Failed to open file \""s + path + "\""s);
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) < 0) {
+		close(fd);
+		throw runtime_error("Failed to stat file \""s + path + "\""s);
 	}
 
-	void operator() (double value) {
-		ctx.PrintIndentWithPrefix();
-		ctx.out << value;
+	const size_t size = static_cast<size_t>(file_stat.st_size);
+
+	// Пустой файл отобразить нельзя, но и читать в нём нечего
+	if (size != 0) {
+		void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address == MAP_FAILED) {
+			close(fd);
+			throw runtime_error("Failed to map file \""s + path + "\""s);
+		}
+
+		// Файл читается один раз от начала до конца
+		madvise(address, size, MADV_SEQUENTIAL);
+		data_ = string_view(static_cast<const char*>(address), size);
 	}
 
-	void operator() (const string& value) {
-		ctx.PrintIndentWithPrefix();
-		ctx.out << "\""sv;
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if (!data_.empty()) munmap(const_cast<char*>(data_.data()), data_.size());
+}
+
+#endif
+
+string_view MappedFile::GetData() const {
+	return data_;
+}
+
+Writer::Writer(ostream& output, PrintFormat format) : output_(&output), format_(format), value_indent_(0u) { }
+
+Writer::Writer(PrintFormat format, size_t indent) : format_(format), value_indent_(indent) { }
+
+Writer& Writer::Null() {
+	BeginValue();
+	buffer_.append("null"sv);
+	return *this;
+}
+
+Writer& Writer::Bool(bool value) {
+	BeginValue();
+	buffer_.append(value ? "true"sv : "false"sv);
+	return *this;
+}
+
+Writer& Writer::Int(int value) {
+	BeginValue();
+
+	char chars[16];
+	const auto result = to_chars(begin(chars), end(chars), value);
+	buffer_.append(chars, result.ptr);
+	return *this;
+}
 
-		for (const char& c : value) {
-			if      (c == '\n') ctx.out << "\\n"sv;
-			else if (c == '\r') ctx.out << "\\r"sv;
-			else if (c == '\"') ctx.out << "\\\""sv;
-			else if (c == '\\') ctx.out << "\\\\"sv;
-			else ctx.out << c;
+Writer& Writer::Double(double value) {
+	BeginValue();
+
+	// Точность 6 в общем формате совпадает с выводом в std::ostream по умолчанию
+	char chars[32];
+	const auto result = to_chars(begin(chars), end(chars), value, chars_format::general, 6);
+	buffer_.append(chars, result.ptr);
+	return *this;
+}
+
+Writer& Writer::String(string_view value) {
+	BeginValue();
+	WriteString(value);
+	return *this;
+}
+
+Writer& Writer::Value(const Node& node) {
+	visit([this](const auto& value) {
+		using T = decay_t<decltype(value)>;
+
+		if constexpr (is_same_v<T, nullptr_t>) {
+			Null();
+		}
+		else if constexpr (is_same_v<T, Array>) {
+			StartArray();
+			for (const Node& item : value) Value(item);
+			EndArray();
+		}
+		else if constexpr (is_same_v<T, Dict>) {
+			StartDict();
+			for (const auto& [key, item] : value) {
+				Key(key);
+				Value(item);
+			}
+			EndDict();
 		}
+		else if constexpr (is_same_v<T, bool>)   { Bool(value);   }
+		else if constexpr (is_same_v<T, int>)    { Int(value);    }
+		else if constexpr (is_same_v<T, double>) { Double(value); }
+		else                                     { String(value); }
+	}, node.GetValue());
+
+	return *this;
+}
+
+Writer& Writer::StartArray() {
+	BeginValue();
+	buffer_.push_back('[');
+	if (format_ == PrintFormat::Pretty) buffer_.push_back('\n');
 
-		ctx.out << "\""sv;
+	frames_.push_back({ false, true, value_indent_ });
+	return *this;
+}
+
+Writer& Writer::EndArray() {
+	if (frames_.empty() || frames_.back().is_dict) throw logic_error("Unexpected end of array"s);
+
+	if (format_ == PrintFormat::Pretty) {
+		buffer_.push_back('\n');
+		Indent(frames_.back().indent);
 	}
-};
+	buffer_.push_back(']');
+
+	frames_.pop_back();
+	return *this;
+}
+
+Writer& Writer::StartDict() {
+	BeginValue();
+	buffer_.push_back('{');
+	if (format_ == PrintFormat::Pretty) buffer_.push_back('\n');
+
+	frames_.push_back({ true, true, value_indent_ });
+	return *this;
+}
+
+Writer& Writer::Key(string_view key) {
+	if (frames_.empty() || !frames_.back().is_dict || key_written_) throw logic_error("Unexpected key"s);
+
+	Frame& frame = frames_.back();
+
+	if (format_ == PrintFormat::Compact) {
+		if (!frame.first) buffer_.push_back(',');
+		WriteString(key);
+		buffer_.push_back(':');
+	}
+	else {
+		if (!frame.first) buffer_.append(", \n"sv);
+
+		// Значение с ключом выравнивается по концу префикса "ключ": (ключ выводится без экранирования)
+		Indent(frame.indent + 4u);
+		buffer_.push_back('"');
+		buffer_.append(key);
+		buffer_.append("\": "sv);
+
+		value_indent_ = frame.indent + 4u + key.size() + 4u;
+	}
+
+	frame.first = false;
+	key_written_ = true;
+	return *this;
+}
+
+Writer& Writer::EndDict() {
+	if (frames_.empty() || !frames_.back().is_dict || key_written_) throw logic_error("Unexpected end of dictionary"s);
 
-void PrintNode(const Node& node, const PrintContext ctx) {
-	visit(NodePrinter{ctx}, node.GetValue());
+	if (format_ == PrintFormat::Pretty) {
+		buffer_.push_back('\n');
+		Indent(frames_.back().indent);
+	}
+	buffer_.push_back('}');
+
+	frames_.pop_back();
+	return *this;
+}
+
+Writer& Writer::RawValue(string_view value) {
+	BeginValue();
+	buffer_.append(value);
+	return *this;
+}
+
+size_t Writer::GetChildIndent() const {
+	return frames_.empty() ? value_indent_ : frames_.back().indent + 4u;
+}
+
+void Writer::Flush() {
+	if (!output_) return;
+
+	output_->write(buffer_.data(), static_cast<streamsize>(buffer_.size()));
+	buffer_.clear();
+}
+
+string Writer::Release() {
+	string result = move(buffer_);
+	buffer_.clear();
+	return result;
 }
 
+void Writer::BeginValue() {
+	if (output_ && buffer_.size() >= FLUSH_SIZE) Flush();
+
+	if (frames_.empty()) return;
+
+	Frame& frame = frames_.back();
+
+	if (frame.is_dict) {
+		if (!key_written_) throw logic_error("Value without key in dictionary"s);
+		key_written_ = false;
+		return;
+	}
+
+	if (format_ == PrintFormat::Compact) {
+		if (!frame.first) buffer_.push_back(',');
+	}
+	else {
+		if (!frame.first) buffer_.append(",\n"sv);
+		Indent(frame.indent + 4u);
+		value_indent_ = frame.indent + 4u;
+	}
+
+	frame.first = false;
+}
+
+void Writer::Indent(size_t indent) {
+	buffer_.append(indent, ' ');
+}
+
+void Writer::WriteString(string_view value) {
+	buffer_.push_back('"');
+
+	// Экранируемые символы редки, поэтому строка между ними выводится целыми кусками
+	size_t pos = 0;
+
+	while (true) {
+		const size_t special = value.find_first_of("\n\r\"\\"sv, pos);
+		buffer_.append(value.substr(pos, special - pos));
+
+		if (special == string_view::npos) break;
+
+		const char c = value[special];
+		if      (c == '\n') buffer_.append("\\n"sv);
+		else if (c == '\r') buffer_.append("\\r"sv);
+		else if (c == '\"') buffer_.append("\\\""sv);
+		else                buffer_.append("\\\\"sv);
+
+		pos = special + 1;
+	}
+
+	buffer_.push_back('"');
 }
 
-void Document::Print(ostream& output) const {
-	detail::PrintNode(GetRoot(), { output, 4, 0 });
+void Document::Print(ostream& output, PrintFormat format) const {
+	Writer writer(output, format);
+	writer.Value(GetRoot());
+	writer.Flush();
 }
 
 }
\ No newline at end of file
@@ -2,9 +2,13 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <variant>
+#include <optional>
+#include <memory>
+#include <cstdint>
 
 namespace json {
 
@@ -56,12 +60,18 @@ private:
 bool operator == (const Node& lhs, const Node& rhs);
 bool operator != (const Node& lhs, const Node& rhs);
 
+// Формат вывода JSON
+enum class PrintFormat {
+    Pretty,  // С переносами строк и отступами
+    Compact  // В одну строку без пробелов
+};
+
 class Document {
 public:
     explicit Document(Node root);
     explicit Document(std::istream& input);
     const Node& GetRoot() const;
-    void Print(std::ostream& output) const;
+    void Print(std::ostream& output, PrintFormat format = PrintFormat::Pretty) const;
 
 private:
     Node root_;
@@ -70,5 +80,312 @@ private:
 bool operator == (const Document& lhs, const Document& rhs);
 bool operator != (const Document& lhs, const Document& rhs);
 
+// Класс буферизованного вывода JSON: значения записываются по одному, без построения DOM. Числа форматируются
+// через std::to_chars, строки экранируются целыми кусками, а формат вывода совпадает с Document::Print.
+// Если задан поток, буфер сбрасывается в него по мере заполнения и при вызове Flush
+class Writer {
+public:
+    explicit Writer(std::ostream& output, PrintFormat format = PrintFormat::Pretty);
+
+    // Вывод только в собственный буфер. indent - отступ, с которым значение будет вставлено
+    // в другой Writer методом RawValue (см. GetChildIndent)
+    explicit Writer(PrintFormat format = PrintFormat::Pretty, size_t indent = 0u);
+
+    Writer& Null();
+    Writer& Bool(bool value);
+    Writer& Int(int value);
+    Writer& Double(double value);
+    Writer& String(std::string_view value);
+
+    // Функция вывода узла DOM целиком
+    Writer& Value(const Node& node);
+
+    Writer& StartArray();
+    Writer& EndArray();
+
+    Writer& StartDict();
+    Writer& Key(std::string_view key);
+    Writer& EndDict();
+
+    // Функция вывода значения, уже записанного другим Writer с отступом GetChildIndent()
+    Writer& RawValue(std::string_view value);
+
+    // Функция получения отступа элементов открытого массива (нужен, чтобы готовить элементы в других Writer)
+    size_t GetChildIndent() const;
+
+    // Функция сброса буфера в поток
+    void Flush();
+
+    // Функция извлечения содержимого буфера (после неё буфер пуст)
+    std::string Release();
+
+private:
+    // Размер буфера, при котором он сбрасывается в поток
+    static constexpr size_t FLUSH_SIZE = 64u * 1024u;
+
+    // Открытый массив или словарь
+    struct Frame {
+        bool   is_dict;
+        bool   first;  // Ещё не выведено ни одного элемента
+        size_t indent; // Отступ закрывающей скобки (элементы выводятся с отступом на 4 больше)
+    };
+
+    // Функция вывода разделителя и отступа перед очередным значением
+    void BeginValue();
+    void Indent(size_t indent);
+    void WriteString(std::string_view value);
+
+    std::ostream* output_ = nullptr;
+    PrintFormat format_;
+    std::string buffer_;
+
+    std::vector<Frame> frames_;
+    size_t value_indent_;     // Отступ закрывающей скобки для очередного значения
+    bool key_written_ = false; // Ключ словаря выведен и ожидает значения
+};
+
+// Функция загрузки документа из непрерывного буфера (однопроходный разбор без потоков)
+Document Load(std::string_view buffer);
+
+// Интерфейс обработчика событий потокового (SAX) разбора JSON.
+// Строки и ключи передаются представлениями, действительными только на время вызова
+class SaxHandler {
+public:
+    virtual void Null() = 0;
+    virtual void Bool(bool value) = 0;
+    virtual void Int(int value) = 0;
+    virtual void Double(double value) = 0;
+    virtual void String(std::string_view value) = 0;
+
+    virtual void StartArray() = 0;
+    virtual void EndArray() = 0;
+
+    virtual void StartDict() = 0;
+    virtual void Key(std::string_view key) = 0;
+    virtual void EndDict() = 0;
+
+protected:
+    // Класс не предполгает полиморфного удаления, поэтому имеет защищённый невертуальный деструктор
+    ~SaxHandler() = default;
+};
+
+// Функция потокового (SAX) разбора непрерывного буфера: вместо построения DOM события передаются обработчику
+void ParseSax(std::string_view buffer, SaxHandler& handler);
+
+// Монотонный аллокатор: память выделяется крупными блоками, а освобождается только вся сразу
+class Arena {
+public:
+    Arena() = default;
+
+    Arena(const Arena&) = delete;
+    Arena& operator = (const Arena&) = delete;
+
+    Arena(Arena&& other) noexcept;
+    Arena& operator = (Arena&& other) noexcept;
+
+    // Функция выделения size байт с выравниванием align
+    void* Allocate(size_t size, size_t align);
+
+    // Функция выделения неинициализированного массива из count объектов типа T
+    template <typename T>
+    T* AllocateArray(size_t count) {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Функция копирования строки в арену
+    std::string_view CopyString(std::string_view str);
+
+    // Функция освобождения всей выделенной памяти (самый большой блок остаётся для повторного использования)
+    void Reset();
+
+private:
+    // Размер первого блока
+    static constexpr size_t MIN_BLOCK_SIZE = 64u * 1024u;
+
+    // Блок памяти
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_; // Блоки (каждый следующий не меньше предыдущего)
+    char* pos_ = nullptr;       // Начало свободной части последнего блока
+    char* end_ = nullptr;       // Конец последнего блока
+};
+
+struct ArenaMember;
+class ArenaArray;
+class ArenaDict;
+
+// Узел JSON, размещённый в арене. Узел не владеет памятью: строки, элементы массивов и словарей
+// лежат в арене и действительны, пока она существует и не сброшена. Копирование узла ничего не стоит
+class ArenaNode {
+public:
+    ArenaNode();
+
+    bool IsNull()       const;
+    bool IsArray()      const;
+    bool IsMap()        const;
+    bool IsBool()       const;
+    bool IsInt()        const;
+    bool IsDouble()     const;
+    bool IsPureDouble() const;
+    bool IsString()     const;
+
+    ArenaArray       AsArray()  const;
+    ArenaDict        AsMap()    const;
+    bool             AsBool()   const;
+    int              AsInt()    const;
+    double           AsDouble() const;
+    std::string_view AsString() const;
+
+private:
+    friend class ArenaBuilder;
+
+    enum class Type : uint8_t { Null, Array, Map, Bool, Int, Double, String };
+
+    Type     type_ = Type::Null;
+    uint32_t size_ = 0; // Длина строки или число элементов массива/словаря
+
+    union {
+        bool               bool_;
+        int                int_;
+        double             double_;
+        const char*        string_;
+        const ArenaNode*   items_;
+        const ArenaMember* members_;
+    };
+};
+
+// Элемент словаря в арене
+struct ArenaMember {
+    std::string_view key;
+    ArenaNode        value;
+};
+
+// Представление массива в арене
+class ArenaArray {
+public:
+    ArenaArray(const ArenaNode* items, size_t size) : items_(items), size_(size) { }
+
+    const ArenaNode* begin() const { return items_; }
+    const ArenaNode* end()   const { return items_ + size_; }
+
+    size_t size()  const { return size_; }
+    bool   empty() const { return size_ == 0; }
+
+    const ArenaNode& operator [] (size_t index) const { return items_[index]; }
+
+private:
+    const ArenaNode* items_;
+    size_t size_;
+};
+
+// Представление словаря в арене: элементы упорядочены по ключу (как в Dict), поиск - двоичный
+class ArenaDict {
+public:
+    ArenaDict(const ArenaMember* members, size_t size) : members_(members), size_(size) { }
+
+    const ArenaMember* begin() const { return members_; }
+    const ArenaMember* end()   const { return members_ + size_; }
+
+    size_t size()  const { return size_; }
+    bool   empty() const { return size_ == 0; }
+
+    // Функция поиска элемента по ключу (если его нет, возвращается end())
+    const ArenaMember* find(std::string_view key) const;
+
+    // Функция получения значения по ключу (если его нет, выбрасывается std::out_of_range)
+    const ArenaNode& at(std::string_view key) const;
+
+private:
+    const ArenaMember* members_;
+    size_t size_;
+};
+
+// Обработчик SAX-событий, собирающий из них узел в арене. Элементы открытых массивов и словарей
+// накапливаются во внутренних буферах, которые переиспользуются, а в арену копируются уже готовыми
+class ArenaBuilder final : public SaxHandler {
+public:
+    explicit ArenaBuilder(Arena& arena);
+
+    void Null() override;
+    void Bool(bool value) override;
+    void Int(int value) override;
+    void Double(double value) override;
+    void String(std::string_view value) override;
+
+    void StartArray() override;
+    void EndArray() override;
+
+    void StartDict() override;
+    void Key(std::string_view key) override;
+    void EndDict() override;
+
+    // Функция проверки, что узел полностью собран
+    bool IsComplete() const;
+
+    // Функция извлечения собранного узла (после неё можно собирать следующий)
+    ArenaNode Extract();
+
+private:
+    // Открытый массив или словарь
+    struct Container {
+        bool is_dict;
+        size_t begin;         // Начало элементов контейнера в items_ или members_
+        std::string_view key; // Ключ, под которым контейнер лежит в родительском словаре
+    };
+
+    // Элемент открытого словаря вместе с порядковым номером (при повторе ключа действует первый элемент, как в Dict)
+    struct PendingMember {
+        std::string_view key;
+        ArenaNode value;
+        size_t order;
+    };
+
+    std::string_view TakeKey();
+    void AddValue(std::string_view key, const ArenaNode& value);
+
+    Arena& arena_;
+
+    std::vector<Container>     containers_; // Открытые массивы и словари
+    std::vector<ArenaNode>     items_;      // Элементы открытых массивов
+    std::vector<PendingMember> members_;    // Элементы открытых словарей
+    std::optional<std::string_view> key_;   // Ключ, ожидающий значения
+    std::optional<ArenaNode> root_;         // Собранный узел
+};
+
+// Класс документа, все узлы и строки которого размещены в собственной арене: большой документ
+// разбирается за несколько крупных выделений памяти и освобождается целиком
+class ArenaDocument {
+public:
+    explicit ArenaDocument(std::string_view buffer);
+
+    const ArenaNode& GetRoot() const;
+
+private:
+    Arena arena_;
+    ArenaNode root_;
+};
+
+// Класс файла, отображённого в память только для чтения (на Windows файл читается в память целиком)
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    // Функция получения содержимого файла
+    std::string_view GetData() const;
+
+private:
+    std::string_view data_;
+#ifdef _WIN32
+    std::string content_;
+#endif
+};
+
 
 }
\ No newline at end of file
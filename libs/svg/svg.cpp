@@ -1,53 +1,144 @@
+#include <charconv>
+#include <iterator>
 #include "svg.h"
 using namespace std;
 
 namespace svg {
 
-// Объект для вывода в поток цвета, представленного в различных форматах (не задан/строка/RGB/RGBa)
+bool operator == (const Rgb& lhs, const Rgb& rhs) {
+    return lhs.red == rhs.red && lhs.green == rhs.green && lhs.blue == rhs.blue;
+}
+
+bool operator != (const Rgb& lhs, const Rgb& rhs) {
+    return !(lhs == rhs);
+}
+
+bool operator == (const Rgba& lhs, const Rgba& rhs) {
+    return lhs.red == rhs.red && lhs.green == rhs.green && lhs.blue == rhs.blue && lhs.opacity == rhs.opacity;
+}
+
+bool operator != (const Rgba& lhs, const Rgba& rhs) {
+    return !(lhs == rhs);
+}
+
+bool operator == (const Point& lhs, const Point& rhs) {
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+bool operator != (const Point& lhs, const Point& rhs) {
+    return !(lhs == rhs);
+}
+
+// Объект для вывода в буфер цвета, представленного в различных форматах (не задан/строка/RGB/RGBa)
 struct ColorPrinter {
-    ostream& out;
+    Buffer& out;
 
-    // Вывод в поток незаданного цвета
+    // Вывод незаданного цвета
     void operator() (monostate) const {
         out << "none"sv;
     }
 
-    // Вывод в поток цвета в формате строки
+    // Вывод цвета в формате строки
     void operator() (const string& str) const {
         out << str;
     }
 
-    // Вывод в поток цвета в формате RGB
+    // Вывод цвета в формате RGB
     void operator() (const Rgb& rgb) const {
-        out << "rgb("sv << unsigned(rgb.red) << ","sv << unsigned(rgb.green) << ","sv << unsigned(rgb.blue) << ")"sv;
+        out << "rgb("sv << uint32_t(rgb.red) << ","sv << uint32_t(rgb.green) << ","sv << uint32_t(rgb.blue) << ")"sv;
     }
-    
-    // Вывод в поток цвета в формате RGBa
+
+    // Вывод цвета в формате RGBa
     void operator() (const Rgba& rgba) const {
-        out << "rgba("sv << unsigned(rgba.red) << ","sv << unsigned(rgba.green) << ","sv << unsigned(rgba.blue) << ","sv << rgba.opacity << ")"sv;
+        out << "rgba("sv << uint32_t(rgba.red) << ","sv << uint32_t(rgba.green) << ","sv << uint32_t(rgba.blue) << ","sv << rgba.opacity << ")"sv;
     }
 };
 
 // Перегрузка оператора "<<" для вывода цвета в поток
 ostream& operator << (ostream& out, const Color color) {
-    visit(ColorPrinter{ out }, color);
-    return out;
+    Buffer buffer;
+    buffer << color;
+    return out << buffer.GetData();
 }
 
 // Перегрузка оператора "<<" для вывода формы конца линии контура в поток
 ostream& operator << (ostream& out, const StrokeLineCap stroke_linecap) {
-    if      (stroke_linecap == StrokeLineCap::BUTT)  return out << "butt"sv;
-    else if (stroke_linecap == StrokeLineCap::ROUND) return out << "round"sv;
-    else                                             return out << "square"sv;
+    Buffer buffer;
+    buffer << stroke_linecap;
+    return out << buffer.GetData();
 }
 
 // Перегрузка оператора "<<" для вывода формы соединения линии контура в поток
 ostream& operator << (ostream& out, const StrokeLineJoin stroke_linejoin) {
-    if      (stroke_linejoin == StrokeLineJoin::ARCS)       return out << "arcs"sv;
-    else if (stroke_linejoin == StrokeLineJoin::BEVEL)      return out << "bevel"sv;
-    else if (stroke_linejoin == StrokeLineJoin::MITER)      return out << "miter"sv;
-    else if (stroke_linejoin == StrokeLineJoin::MITER_CLIP) return out << "miter-clip"sv;
-    else                                                    return out << "round"sv;
+    Buffer buffer;
+    buffer << stroke_linejoin;
+    return out << buffer.GetData();
+}
+
+Buffer& Buffer::operator << (string_view str) {
+    data_.append(str);
+    return *this;
+}
+
+Buffer& Buffer::operator << (const string& str) {
+    data_.append(str);
+    return *this;
+}
+
+Buffer& Buffer::operator << (char ch) {
+    data_.push_back(ch);
+    return *this;
+}
+
+Buffer& Buffer::operator << (double value) {
+    // Точность 6 в общем формате совпадает с выводом в std::ostream по умолчанию
+    char chars[32];
+    const auto result = to_chars(begin(chars), end(chars), value, chars_format::general, 6);
+    data_.append(chars, result.ptr);
+    return *this;
+}
+
+Buffer& Buffer::operator << (uint32_t value) {
+    char chars[16];
+    const auto result = to_chars(begin(chars), end(chars), value);
+    data_.append(chars, result.ptr);
+    return *this;
+}
+
+Buffer& Buffer::operator << (const Color& color) {
+    visit(ColorPrinter{ *this }, color);
+    return *this;
+}
+
+Buffer& Buffer::operator << (StrokeLineCap stroke_linecap) {
+    if      (stroke_linecap == StrokeLineCap::BUTT)  return *this << "butt"sv;
+    else if (stroke_linecap == StrokeLineCap::ROUND) return *this << "round"sv;
+    else                                             return *this << "square"sv;
+}
+
+Buffer& Buffer::operator << (StrokeLineJoin stroke_linejoin) {
+    if      (stroke_linejoin == StrokeLineJoin::ARCS)       return *this << "arcs"sv;
+    else if (stroke_linejoin == StrokeLineJoin::BEVEL)      return *this << "bevel"sv;
+    else if (stroke_linejoin == StrokeLineJoin::MITER)      return *this << "miter"sv;
+    else if (stroke_linejoin == StrokeLineJoin::MITER_CLIP) return *this << "miter-clip"sv;
+    else                                                    return *this << "round"sv;
+}
+
+// Функция вывода отступа из indent пробелов
+void Buffer::Indent(int indent) {
+    if (indent > 0) data_.append(static_cast<size_t>(indent), ' ');
+}
+
+// Функция получения содержимого буфера
+string_view Buffer::GetData() const {
+    return data_;
+}
+
+// Функция извлечения содержимого буфера (после неё буфер пуст)
+string Buffer::Release() {
+    string result = move(data_);
+    data_.clear();
+    return result;
 }
 
 // Функция рендера объекта (реализует паттерн "Шаблонный метод")
@@ -56,8 +147,8 @@ void Object::Render(const RenderContext& ctx) const {
     ctx.RenderIndent();
     // Делегируем непосредственный рендер своим подклассам
     RenderObject(ctx);
-    // Выводим перенос на новую строку
-    ctx.out << endl;
+    // Выводим перенос на новую строку (без сброса потока после каждого объекта)
+    ctx.out << '\n';
 }
 
 // Функция задания центра круга (атрибуты cx и cy)
@@ -72,12 +163,19 @@ Circle& Circle::SetRadius(double radius)  {
     return *this;
 }
 
+// Функция рендера круга в буфер (без виртуального вызова и без отступа)
+void Circle::RenderTo(Buffer& out) const {
+    out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
+    out << "r=\""sv << radius_ << "\""sv;
+    RenderAttrs(out);
+    out << "/>"sv;
+}
+
 // Функция рендера круга для вызова в Object::Render, реализующей паттерн "Шаблонный метод"
 void Circle::RenderObject(const RenderContext& ctx) const {
-    ctx.out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-    ctx.out << "r=\""sv << radius_ << "\""sv;
-    RenderAttrs(ctx.out);
-    ctx.out << "/>"sv;
+    Buffer buffer;
+    RenderTo(buffer);
+    ctx.out << buffer.GetData();
 }
 
 // Функция добавления точки в ломаную
@@ -86,20 +184,27 @@ Polyline& Polyline::AddPoint(Point point) {
     return *this;
 }
 
-// Функция рендера ломаной для вызова в Object::Render, реализующей паттерн "Шаблонный метод"
-void Polyline::RenderObject(const RenderContext& ctx) const {
-    ctx.out << "<polyline points=\""sv;
+// Функция рендера ломаной в буфер (без виртуального вызова и без отступа)
+void Polyline::RenderTo(Buffer& out) const {
+    out << "<polyline points=\""sv;
 
     bool first = true;
     for (const Point& p : points_) {
-        if (!first) ctx.out << " "sv;
+        if (!first) out << " "sv;
         else        first = false;
-        ctx.out << p.x << ","sv << p.y;
+        out << p.x << ","sv << p.y;
     }
 
-    ctx.out << "\""sv;
-    RenderAttrs(ctx.out);
-    ctx.out << " />"sv;
+    out << "\""sv;
+    RenderAttrs(out);
+    out << " />"sv;
+}
+
+// Функция рендера ломаной для вызова в Object::Render, реализующей паттерн "Шаблонный метод"
+void Polyline::RenderObject(const RenderContext& ctx) const {
+    Buffer buffer;
+    RenderTo(buffer);
+    ctx.out << buffer.GetData();
 }
 
 // Функция задания координаты опорной точки текста (атрибуты x и y)
@@ -138,27 +243,44 @@ Text& Text::SetData(string data) {
     return *this;
 }
 
-// Функция рендера текста для вызова в Object::Render, реализующей паттерн "Шаблонный метод"
-void Text::RenderObject(const RenderContext& ctx) const {
-    ctx.out << "<text"sv;
-    RenderAttrs(ctx.out);
-    ctx.out << " x=\""sv << pos_.x << "\" y=\""sv << pos_.y << "\" dx=\""sv << offset_.x << "\" dy=\""sv << offset_.y << "\" font-size=\""sv << size_ << "\""sv;
+// Функция рендера текста в буфер (без виртуального вызова и без отступа)
+void Text::RenderTo(Buffer& out) const {
+    out << "<text"sv;
+    RenderAttrs(out);
+    out << " x=\""sv << pos_.x << "\" y=\""sv << pos_.y << "\" dx=\""sv << offset_.x << "\" dy=\""sv << offset_.y << "\" font-size=\""sv << size_ << "\""sv;
 
-    if (!font_family_.empty()) ctx.out << " font-family=\""sv << font_family_ << "\""sv;
-    if (!font_weight_.empty()) ctx.out << " font-weight=\""sv << font_weight_ << "\""sv;
+    if (!font_family_.empty()) out << " font-family=\""sv << font_family_ << "\""sv;
+    if (!font_weight_.empty()) out << " font-weight=\""sv << font_weight_ << "\""sv;
 
-    ctx.out << ">"sv;
-    
-    for (const char c : data_) {
-        if      (c == '\"') { ctx.out << "&quot;"sv; }
-        else if (c == '\'') { ctx.out << "&apos;"sv; }
-        else if (c == '<')  { ctx.out << "&lt;"sv;   }
-        else if (c == '<')  { ctx.out << "&gt;"sv;   }
-        else if (c == '&')  { ctx.out << "&amp;"sv;  }
-        else                { ctx.out << c;          }
+    out << ">"sv;
+
+    // Экранируемые символы редки, поэтому текст между ними выводится целыми кусками
+    string_view data = data_;
+    size_t pos = 0;
+
+    while (true) {
+        const size_t special = data.find_first_of("\"'<&"sv, pos);
+        out << data.substr(pos, special - pos);
+
+        if (special == string_view::npos) break;
+
+        const char c = data[special];
+        if      (c == '\"') { out << "&quot;"sv; }
+        else if (c == '\'') { out << "&apos;"sv; }
+        else if (c == '<')  { out << "&lt;"sv;   }
+        else if (c == '&')  { out << "&amp;"sv;  }
+
+        pos = special + 1;
     }
-    
-    ctx.out << "</text>"sv;
+
+    out << "</text>"sv;
+}
+
+// Функция рендера текста для вызова в Object::Render, реализующей паттерн "Шаблонный метод"
+void Text::RenderObject(const RenderContext& ctx) const {
+    Buffer buffer;
+    RenderTo(buffer);
+    ctx.out << buffer.GetData();
 }
 
 // Функция добавления объекта (наследника svg::Object) в svg-документ по указателю
@@ -168,8 +290,8 @@ void Document::AddPtr(unique_ptr<Object>&& object) {
 
 // Функция рендера svg-документа
 void Document::Render(ostream& out) const {
-    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << endl;
-    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << endl;
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << '\n';
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << '\n';
 
     RenderContext ctx{out, 2, 2};
 
@@ -180,4 +302,30 @@ void Document::Render(ostream& out) const {
     out << "</svg>"sv;
 }
 
-} 
\ No newline at end of file
+// Функция резервирования места под count объектов
+void FlatDocument::Reserve(size_t count) {
+    objects_.reserve(count);
+}
+
+// Функция рендера svg-документа в буфер
+void FlatDocument::Render(Buffer& out) const {
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
+
+    for (const auto& object : objects_) {
+        out.Indent(2);
+        visit([&out](const auto& obj) { obj.RenderTo(out); }, object);
+        out << '\n';
+    }
+
+    out << "</svg>"sv;
+}
+
+// Функция рендера svg-документа в поток
+void FlatDocument::Render(ostream& out) const {
+    Buffer buffer;
+    Render(buffer);
+    out << buffer.GetData();
+}
+
+}
\ No newline at end of file
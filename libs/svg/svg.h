@@ -7,6 +7,7 @@
 #include <memory>
 #include <variant>
 #include <optional>
+#include <string_view>
 
 namespace svg {
 
@@ -33,6 +34,12 @@ struct Rgba {
     double opacity = 1.0;
 };
 
+bool operator == (const Rgb& lhs, const Rgb& rhs);
+bool operator != (const Rgb& lhs, const Rgb& rhs);
+
+bool operator == (const Rgba& lhs, const Rgba& rhs);
+bool operator != (const Rgba& lhs, const Rgba& rhs);
+
 // Цвет может быть не задан, либо представлен в формате строки, формате RGB или формате RGBa
 using Color = std::variant<std::monostate, std::string, Rgb, Rgba>;
 
@@ -60,6 +67,35 @@ struct Point {
     double y = 0;
 };
 
+bool operator == (const Point& lhs, const Point& rhs);
+bool operator != (const Point& lhs, const Point& rhs);
+
+// Буфер вывода SVG: текст дописывается в непрерывную строку, а числа форматируются через to_chars
+// (в том же виде, что и при выводе в std::ostream с настройками по умолчанию)
+class Buffer {
+public:
+    Buffer& operator << (std::string_view str);
+    Buffer& operator << (const std::string& str);
+    Buffer& operator << (char ch);
+    Buffer& operator << (double value);
+    Buffer& operator << (uint32_t value);
+    Buffer& operator << (const Color& color);
+    Buffer& operator << (StrokeLineCap stroke_linecap);
+    Buffer& operator << (StrokeLineJoin stroke_linejoin);
+
+    // Функция вывода отступа из indent пробелов
+    void Indent(int indent);
+
+    // Функция получения содержимого буфера
+    std::string_view GetData() const;
+
+    // Функция извлечения содержимого буфера (после неё буфер пуст)
+    std::string Release();
+
+private:
+    std::string data_;
+};
+
 // Вспомогательная структура для вывода содержимого с отступами
 struct RenderContext {
     // Наличие конструкторов требовали тесты тренажёра
@@ -133,7 +169,7 @@ protected:
     ~PathProps() = default;
 
     // Функция рендера свойств заливки и линии контура объекта
-    void RenderAttrs(std::ostream& out) const {
+    void RenderAttrs(Buffer& out) const {
         using namespace std::literals;
 
         if (fill_color_)      out << " fill=\""sv            << *fill_color_      << "\""sv;
@@ -164,6 +200,9 @@ public:
     // Функция задания радиуса круга (атрибут r)
     Circle& SetRadius(double radius);
 
+    // Функция рендера круга в буфер (без виртуального вызова и без отступа)
+    void RenderTo(Buffer& out) const;
+
 private:
     // Функция рендера круга для вызова в Object::Render, реализующей паттерн "Шаблонный метод"
     void RenderObject(const RenderContext& ctx) const override;
@@ -179,6 +218,9 @@ public:
     // Функция добавления точки в ломаную
     Polyline& AddPoint(Point point);
 
+    // Функция рендера ломаной в буфер (без виртуального вызова и без отступа)
+    void RenderTo(Buffer& out) const;
+
 private:
     // Функция рендера ломаной для вызова в Object::Render, реализующей паттерн "Шаблонный метод"
     void RenderObject(const RenderContext& ctx) const override;
@@ -208,6 +250,9 @@ public:
     // Функция задания содержимого текста (отображается внутри тега text)
     Text& SetData(std::string data);
 
+    // Функция рендера текста в буфер (без виртуального вызова и без отступа)
+    void RenderTo(Buffer& out) const;
+
 private:
     // Функция рендера текста для вызова в Object::Render, реализующей паттерн "Шаблонный метод"
     void RenderObject(const RenderContext& ctx) const override;
@@ -262,4 +307,27 @@ private:
     std::vector<std::unique_ptr<Object>> objects_;
 };
 
+// Класс svg-документа, хранящего объекты по значению (без выделения памяти под каждый объект
+// и без виртуальных вызовов). Документ рендерится в один буфер и выводится в поток одной записью
+class FlatDocument {
+public:
+    // Функция добавления объекта в svg-документ по значению
+    template <typename ObjectType>
+    void Add(ObjectType object) {
+        objects_.emplace_back(std::move(object));
+    }
+
+    // Функция резервирования места под count объектов
+    void Reserve(size_t count);
+
+    // Функция рендера svg-документа в буфер
+    void Render(Buffer& out) const;
+
+    // Функция рендера svg-документа в поток
+    void Render(std::ostream& out) const;
+
+private:
+    std::vector<std::variant<Circle, Polyline, Text>> objects_;
+};
+
 }
\ No newline at end of file
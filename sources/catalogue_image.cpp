@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <numeric>
+#include <fstream>
+#include <cstring>
+#include <unordered_map>
+#include "catalogue_image.h"
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с образом базы данных, который используется прямо из памяти
+namespace catalogue_image {
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue::catalogue_image
+namespace detail {
+
+// Сигнатура образа базы данных
+constexpr char SIGNATURE[8] = { 'T', 'C', 'I', 'M', 'A', 'G', 'E', '\0' };
+
+// Выравнивание разделов образа
+constexpr size_t ALIGNMENT = 8;
+
+// Функция добавления раздела в образ: раздел выравнивается, возвращается его смещение
+template <typename Record>
+uint64_t AppendSection(string& image, const vector<Record>& records) {
+    image.resize((image.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, '\0');
+    const uint64_t offset = image.size();
+    image.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+    return offset;
+}
+
+// Функция получения указателя на раздел образа с проверкой того, что раздел целиком лежит внутри образа
+template <typename Record>
+const Record* GetSection(string_view image, uint64_t offset, uint64_t count) {
+    if (offset % ALIGNMENT != 0 || offset > image.size() || count > (image.size() - offset) / sizeof(Record)) {
+        throw ImageError("Catalogue image section is out of bounds"s);
+    }
+    return reinterpret_cast<const Record*>(image.data() + offset);
+}
+
+}
+
+// Функция сохранения замороженной базы данных в виде образа, который можно использовать прямо из памяти.
+// Идентификаторы остановок и маршрутов в образе - номера в порядке названий, а не идентификаторы справочника
+void SaveImage(ostream& output, const TransportCatalogue& catalogue) {
+    using namespace detail;
+
+    const auto& stops = catalogue.GetStops();
+    const auto& buses = catalogue.GetBuses();
+
+    // Остановки в образе упорядочены по названию, чтобы искать их двоичным поиском (удалённые в образ не попадают)
+    vector<StopId> stops_order;
+    stops_order.reserve(stops.size());
+
+    for (StopId id = 0; id < stops.size(); ++id) {
+        if (!catalogue.IsStopRemoved(id)) stops_order.push_back(id);
+    }
+
+    sort(stops_order.begin(), stops_order.end(), [&stops](StopId lhs, StopId rhs) { return stops[lhs].name < stops[rhs].name; });
+
+    vector<uint32_t> stop_positions(stops.size());
+    for (uint32_t position = 0; position < stops_order.size(); ++position) {
+        stop_positions[stops_order[position]] = position;
+    }
+
+    // В образ попадают только действующие маршруты (из повторно добавленных с тем же названием - последний)
+    vector<BusId> buses_order;
+    for (BusId id = 0; id < buses.size(); ++id) {
+        if (catalogue.FindBusId(buses[id].name) == id) buses_order.push_back(id);
+    }
+    sort(buses_order.begin(), buses_order.end(), [&buses](BusId lhs, BusId rhs) { return buses[lhs].name < buses[rhs].name; });
+
+    unordered_map<string_view, uint32_t> bus_positions;
+    for (uint32_t position = 0; position < buses_order.size(); ++position) {
+        bus_positions[buses[buses_order[position]].name] = position;
+    }
+
+    string names;
+
+    // Записи остановок
+    vector<StopRecord> stop_records;
+    vector<uint32_t>   stop_buses;
+    stop_records.reserve(stops.size());
+
+    for (StopId id : stops_order) {
+        const Stop& stop = stops[id];
+
+        StopRecord record{};
+        record.lat         = stop.coordinate.lat;
+        record.lng         = stop.coordinate.lng;
+        record.name_offset = static_cast<uint32_t>(names.size());
+        record.name_length = static_cast<uint32_t>(stop.name.size());
+        record.buses_begin = static_cast<uint32_t>(stop_buses.size());
+
+        // Названия маршрутов упорядочены, поэтому и номера их записей идут по возрастанию
+        const StopInfo info = *catalogue.GetStopInfo(stop.name);
+        for (string_view bus : info.buses) {
+            stop_buses.push_back(bus_positions.at(bus));
+        }
+
+        record.buses_end = static_cast<uint32_t>(stop_buses.size());
+
+        names.append(stop.name);
+        stop_records.push_back(record);
+    }
+
+    // Записи маршрутов
+    vector<BusRecord> bus_records;
+    vector<uint32_t>  bus_stops;
+    bus_records.reserve(buses_order.size());
+
+    for (BusId id : buses_order) {
+        const Bus& bus = buses[id];
+        const BusInfo info = *catalogue.GetBusInfo(bus.name);
+
+        BusRecord record{};
+        record.route_length        = info.route_length;
+        record.curvature           = info.curvature;
+        record.name_offset         = static_cast<uint32_t>(names.size());
+        record.name_length         = static_cast<uint32_t>(bus.name.size());
+        record.stops_begin         = static_cast<uint32_t>(bus_stops.size());
+        record.stops_number        = static_cast<uint32_t>(info.stops_number);
+        record.unique_stops_number = static_cast<uint32_t>(info.unique_stops_number);
+        record.type                = bus.type == BusRouteType::Circle ? 1u : 0u;
+
+        for (StopId stop : bus.stops) {
+            bus_stops.push_back(stop_positions[stop]);
+        }
+
+        record.stops_end = static_cast<uint32_t>(bus_stops.size());
+
+        names.append(bus.name);
+        bus_records.push_back(record);
+    }
+
+    // Расстояния в формате CSR (обратные расстояния достраиваются так же, как в справочнике)
+    vector<pair<uint32_t, DistanceRecord>> all_distances;
+
+    for (const RoadDistance& distance : catalogue.GetRoadDistances()) {
+        for (const auto& [from, to] : { pair{ distance.from, distance.to }, pair{ distance.to, distance.from } }) {
+            all_distances.push_back({ stop_positions[from], DistanceRecord{ stop_positions[to], *catalogue.GetDistance(from, to) } });
+        }
+    }
+
+    sort(all_distances.begin(), all_distances.end(), [](const auto& lhs, const auto& rhs) {
+        return tie(lhs.first, lhs.second.to) < tie(rhs.first, rhs.second.to);
+    });
+
+    all_distances.erase(unique(all_distances.begin(), all_distances.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first == rhs.first && lhs.second.to == rhs.second.to;
+    }), all_distances.end());
+
+    vector<uint32_t>       distance_offsets(stops_order.size() + 1, 0u);
+    vector<DistanceRecord> distances;
+    distances.reserve(all_distances.size());
+
+    for (const auto& [from, record] : all_distances) {
+        ++distance_offsets[from + 1];
+        distances.push_back(record);
+    }
+
+    for (size_t i = 1; i < distance_offsets.size(); ++i) {
+        distance_offsets[i] += distance_offsets[i - 1];
+    }
+
+    // Собираем образ: заголовок, затем разделы
+    ImageHeader header{};
+    memcpy(header.signature, SIGNATURE, sizeof(SIGNATURE));
+    header.version          = IMAGE_VERSION;
+    header.stops_count      = static_cast<uint32_t>(stop_records.size());
+    header.buses_count      = static_cast<uint32_t>(bus_records.size());
+    header.stop_buses_count = static_cast<uint32_t>(stop_buses.size());
+    header.bus_stops_count  = static_cast<uint32_t>(bus_stops.size());
+    header.distances_count  = static_cast<uint32_t>(distances.size());
+
+    string image(sizeof(ImageHeader), '\0');
+
+    header.names_offset            = AppendSection(image, vector<char>(names.begin(), names.end()));
+    header.names_size              = names.size();
+    header.stops_offset            = AppendSection(image, stop_records);
+    header.stop_buses_offset       = AppendSection(image, stop_buses);
+    header.buses_offset            = AppendSection(image, bus_records);
+    header.bus_stops_offset        = AppendSection(image, bus_stops);
+    header.distance_offsets_offset = AppendSection(image, distance_offsets);
+    header.distances_offset        = AppendSection(image, distances);
+    header.image_size              = image.size();
+
+    memcpy(image.data(), &header, sizeof(header));
+
+    output.write(image.data(), static_cast<streamsize>(image.size()));
+}
+
+// Функция сохранения образа базы данных в файл
+void SaveImageToFile(const string& file, const TransportCatalogue& catalogue) {
+    ofstream output(file, ios::binary);
+    if (!output) throw ImageError("Cannot open catalogue image \""s + file + "\" for writing"s);
+
+    SaveImage(output, catalogue);
+
+    if (!output) throw ImageError("Cannot write catalogue image \""s + file + "\""s);
+}
+
+MappedCatalogue::MappedCatalogue(const string& file) : file_(file) {
+    using namespace detail;
+
+    const string_view image = file_.GetData();
+
+    if (image.size() < sizeof(ImageHeader) || memcmp(image.data(), SIGNATURE, sizeof(SIGNATURE)) != 0) {
+        throw ImageError("Invalid catalogue image signature"s);
+    }
+
+    header_ = reinterpret_cast<const ImageHeader*>(image.data());
+
+    if (header_->version != IMAGE_VERSION) {
+        throw ImageError("Unsupported catalogue image format version "s + to_string(header_->version));
+    }
+
+    if (header_->image_size != image.size()) {
+        throw ImageError("Catalogue image is truncated"s);
+    }
+
+    names_            = GetSection<char>(image, header_->names_offset, header_->names_size);
+    stops_            = GetSection<StopRecord>(image, header_->stops_offset, header_->stops_count);
+    stop_buses_       = GetSection<uint32_t>(image, header_->stop_buses_offset, header_->stop_buses_count);
+    buses_            = GetSection<BusRecord>(image, header_->buses_offset, header_->buses_count);
+    GetSection<uint32_t>(image, header_->bus_stops_offset, header_->bus_stops_count);
+    distance_offsets_ = GetSection<uint32_t>(image, header_->distance_offsets_offset, uint64_t{ header_->stops_count } + 1);
+    distances_        = GetSection<DistanceRecord>(image, header_->distances_offset, header_->distances_count);
+
+    if (distance_offsets_[header_->stops_count] != header_->distances_count) {
+        throw ImageError("Catalogue image distances table is corrupted"s);
+    }
+
+    // Номера маршрутов на остановках переводятся в названия (и заодно проверяются) один раз при открытии
+    stop_bus_names_.reserve(header_->stop_buses_count);
+
+    for (uint32_t i = 0; i < header_->stop_buses_count; ++i) {
+        const uint32_t bus_id = stop_buses_[i];
+        if (bus_id >= header_->buses_count) throw ImageError("Catalogue image stop record is corrupted"s);
+        stop_bus_names_.push_back(GetName(buses_[bus_id].name_offset, buses_[bus_id].name_length));
+    }
+}
+
+// Функция получения числа остановок
+size_t MappedCatalogue::GetStopsCount() const {
+    return header_->stops_count;
+}
+
+// Функция получения числа маршрутов
+size_t MappedCatalogue::GetBusesCount() const {
+    return header_->buses_count;
+}
+
+// Функция получения названия по его положению в разделе названий
+string_view MappedCatalogue::GetName(uint32_t offset, uint32_t length) const {
+    if (uint64_t{ offset } + length > header_->names_size) {
+        throw ImageError("Catalogue image name is out of bounds"s);
+    }
+    return string_view(names_ + offset, length);
+}
+
+// Функция поиска номера остановки в образе по её названию
+optional<StopId> MappedCatalogue::FindStopId(string_view name) const {
+    const auto end = stops_ + header_->stops_count;
+    const auto it  = lower_bound(stops_, end, name, [this](const detail::StopRecord& stop, string_view name) {
+        return GetName(stop.name_offset, stop.name_length) < name;
+    });
+
+    if (it == end || GetName(it->name_offset, it->name_length) != name) return nullopt;
+
+    return static_cast<StopId>(it - stops_);
+}
+
+// Функция поиска номера маршрута в образе по его названию
+optional<BusId> MappedCatalogue::FindBusId(string_view name) const {
+    const auto end = buses_ + header_->buses_count;
+    const auto it  = lower_bound(buses_, end, name, [this](const detail::BusRecord& bus, string_view name) {
+        return GetName(bus.name_offset, bus.name_length) < name;
+    });
+
+    if (it == end || GetName(it->name_offset, it->name_length) != name) return nullopt;
+
+    return static_cast<BusId>(it - buses_);
+}
+
+// Функция получения дорожного расстояния между остановками (если прямого нет, то берётся обратное)
+optional<int> MappedCatalogue::GetDistance(StopId from, StopId to) const {
+    if (from >= header_->stops_count) return nullopt;
+
+    if (distance_offsets_[from] > distance_offsets_[from + 1] || distance_offsets_[from + 1] > header_->distances_count) {
+        throw ImageError("Catalogue image distances table is corrupted"s);
+    }
+
+    const auto begin = distances_ + distance_offsets_[from];
+    const auto end   = distances_ + distance_offsets_[from + 1];
+
+    const auto it = lower_bound(begin, end, to, [](const detail::DistanceRecord& distance, StopId stop) { return distance.to < stop; });
+    if (it == end || it->to != to) return nullopt;
+
+    return it->distance;
+}
+
+// Функция получения информации об остановке
+optional<StopInfo> MappedCatalogue::GetStopInfo(string_view name) const {
+    const auto stop_id = FindStopId(name);
+    if (!stop_id) return nullopt;
+
+    const detail::StopRecord& stop = stops_[*stop_id];
+
+    if (stop.buses_begin > stop.buses_end || stop.buses_end > header_->stop_buses_count) {
+        throw ImageError("Catalogue image stop record is corrupted"s);
+    }
+
+    return StopInfo{ GetName(stop.name_offset, stop.name_length),
+                     Span<string_view>(stop_bus_names_.data() + stop.buses_begin, stop.buses_end - stop.buses_begin) };
+}
+
+// Функция получения информации о маршруте
+optional<BusInfo> MappedCatalogue::GetBusInfo(string_view name) const {
+    const auto bus_id = FindBusId(name);
+    if (!bus_id) return nullopt;
+
+    const detail::BusRecord& bus = buses_[*bus_id];
+
+    return BusInfo{ GetName(bus.name_offset, bus.name_length), bus.stops_number, bus.unique_stops_number, bus.route_length, bus.curvature };
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include "catalogue_versions.h"
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с версиями базы данных, которые подменяются во время работы сервера
+namespace versioning {
+
+// Функция загрузки снимка базы данных из бинарного файла (справочник заморожен, граф маршрутов построен)
+unique_ptr<Snapshot> LoadSnapshot(const serialization::SerializationSettings& serialization_settings) {
+    auto snapshot = make_unique<Snapshot>();
+
+    serialization::BaseSettings base_settings = snapshot->handler.LoadBase(serialization_settings);
+    snapshot->render_settings = move(base_settings.render_settings);
+
+    return snapshot;
+}
+
+VersionedCatalogue::PinnedSnapshot::PinnedSnapshot(const VersionedCatalogue* owner, detail::ReaderSlot* slot, const Snapshot* snapshot) : owner_(owner),
+                                                                                                                                       slot_(slot),
+                                                                                                                                       snapshot_(snapshot) { }
+
+VersionedCatalogue::PinnedSnapshot::PinnedSnapshot(PinnedSnapshot&& other) noexcept : owner_(other.owner_),
+                                                                                      slot_(exchange(other.slot_, nullptr)),
+                                                                                      snapshot_(exchange(other.snapshot_, nullptr)) { }
+
+VersionedCatalogue::PinnedSnapshot::~PinnedSnapshot() {
+    if (slot_) owner_->Unpin(*slot_);
+}
+
+VersionedCatalogue::VersionedCatalogue(unique_ptr<Snapshot> snapshot) {
+    snapshot->version = 1;
+    current_.store(snapshot.release());
+}
+
+// Деструктор удаляет все снимки, поэтому к этому моменту читателей остаться не должно
+VersionedCatalogue::~VersionedCatalogue() {
+    delete current_.load();
+}
+
+// Функция закрепления текущего снимка (можно одновременно вызывать из любого числа потоков).
+// Если все слоты читателей заняты, функция ждёт освобождения любого из них
+VersionedCatalogue::PinnedSnapshot VersionedCatalogue::Pin() const {
+    // Поиск свободного слота начинается с того, который поток занимал в прошлый раз
+    thread_local size_t hint = hash<thread::id>{}(this_thread::get_id()) % READER_SLOTS;
+
+    while (true) {
+        for (size_t attempt = 0; attempt < READER_SLOTS; ++attempt) {
+            const size_t index = (hint + attempt) % READER_SLOTS;
+            detail::ReaderSlot& slot = slots_[index];
+
+            // Эпоха могла увеличиться после чтения: устаревшая (меньшая) эпоха лишь дольше удерживает старые снимки
+            uint64_t expected = detail::ReaderSlot::IDLE;
+            if (slot.epoch.load(memory_order_relaxed) == expected && slot.epoch.compare_exchange_strong(expected, epoch_.load())) {
+                hint = index;
+
+                // Указатель читается после того, как эпоха отмечена в слоте (оба действия - seq_cst, как и у писателя),
+                // поэтому снимок, удалённый писателем, прочитан быть не может
+                return PinnedSnapshot(this, &slot, current_.load());
+            }
+        }
+
+        // Все слоты заняты: ждём, пока какой-нибудь из них освободится
+        ++waiters_;
+        {
+            unique_lock lock(readers_mutex_);
+            reader_released_.wait(lock, [this] {
+                return any_of(slots_.begin(), slots_.end(), [](const detail::ReaderSlot& slot) {
+                    return slot.epoch.load() == detail::ReaderSlot::IDLE;
+                });
+            });
+        }
+        --waiters_;
+    }
+}
+
+// Функция публикации следующего снимка. Предыдущий снимок удаляется сразу, если его никто не читает,
+// иначе - при одном из следующих вызовов Publish или Reclaim. Возвращает номер версии опубликованного снимка
+uint64_t VersionedCatalogue::Publish(unique_ptr<Snapshot> snapshot) {
+    lock_guard lock(writer_mutex_);
+
+    const uint64_t version = current_.load()->version + 1;
+    snapshot->version = version;
+
+    unique_ptr<Snapshot> previous(current_.exchange(snapshot.release()));
+
+    // Читатели, отметившие эпоху после её увеличения, уже видят новый снимок
+    const uint64_t retire_epoch = epoch_.fetch_add(1) + 1;
+    retired_.push_back({ retire_epoch, move(previous) });
+
+    ReclaimLocked();
+
+    return version;
+}
+
+// Функция удаления отложенных снимков, которые больше никто не читает. Возвращает число оставшихся отложенных снимков
+size_t VersionedCatalogue::Reclaim() {
+    lock_guard lock(writer_mutex_);
+    return ReclaimLocked();
+}
+
+// Функция ожидания, пока отпустят все читатели отложенных снимков, и удаления этих снимков
+void VersionedCatalogue::ReclaimAll() {
+    lock_guard lock(writer_mutex_);
+    if (retired_.empty()) return;
+
+    // Снимки отложены в порядке публикации, поэтому достаточно дождаться эпохи удаления последнего из них
+    const uint64_t retire_epoch = retired_.back().first;
+
+    ++waiters_;
+    {
+        unique_lock readers_lock(readers_mutex_);
+        reader_released_.wait(readers_lock, [this, retire_epoch] { return GetMinReaderEpoch() >= retire_epoch; });
+    }
+    --waiters_;
+
+    // Снимки удаляются уже без readers_mutex_, чтобы не задерживать освобождающих слоты читателей
+    ReclaimLocked();
+}
+
+// Функция получения номера версии текущего снимка
+uint64_t VersionedCatalogue::GetVersion() const {
+    return Pin()->version;
+}
+
+// Функция освобождения слота читателя (будит ожидающих читателей, если они есть)
+void VersionedCatalogue::Unpin(detail::ReaderSlot& slot) const {
+    // Запись в слот и чтение числа ожидающих (как и у ожидающих в обратном порядке) - seq_cst: либо ожидающий
+    // увидит свободный слот, либо читатель увидит ожидающего. Захват мьютекса перед уведомлением не даёт уведомлению
+    // проскочить между проверкой условия ожидающим и его засыпанием
+    slot.epoch.store(detail::ReaderSlot::IDLE);
+    if (waiters_.load() == 0) return;
+
+    { lock_guard lock(readers_mutex_); }
+    reader_released_.notify_all();
+}
+
+// Функция получения самой ранней эпохи, которую ещё может читать кто-то из читателей
+uint64_t VersionedCatalogue::GetMinReaderEpoch() const {
+    uint64_t min_epoch = detail::ReaderSlot::IDLE;
+    for (const detail::ReaderSlot& slot : slots_) {
+        min_epoch = min(min_epoch, slot.epoch.load());
+    }
+    return min_epoch;
+}
+
+// Функция удаления отложенных снимков (вызывается под writer_mutex_)
+size_t VersionedCatalogue::ReclaimLocked() {
+    const uint64_t min_epoch = GetMinReaderEpoch();
+
+    retired_.erase(remove_if(retired_.begin(), retired_.end(), [min_epoch](const auto& retired) {
+        return retired.first <= min_epoch;
+    }), retired_.end());
+
+    return retired_.size();
+}
+
+}
+
+}
\ No newline at end of file
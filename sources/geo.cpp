@@ -1,5 +1,6 @@
 #include <string>
 #include <cmath>
+#include <algorithm>
 #include "geo.h"
 using namespace std;
 
@@ -17,8 +18,100 @@ bool operator != (const Coordinate& lhs, const Coordinate& rhs) {
 // Функция вычисления расстояния между координатами
 double ComputeDistance(const Coordinate& from, const Coordinate& to) {
     if (from == to) return 0;
-    static const double dr = 3.1415926535 / 180.;
-    return acos(sin(from.lat * dr) * sin(to.lat * dr) + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr)) * 6371000;
+    static const double dr = DEG_TO_RAD;
+    return acos(sin(from.lat * dr) * sin(to.lat * dr) + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr)) * EARTH_RADIUS;
+}
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы geo
+namespace detail {
+
+// Размер блока пакетного вычисления (промежуточные массивы блока помещаются на стеке и в кэше L1)
+constexpr size_t BLOCK_SIZE = 64;
+
+}
+
+// Функция резервирования места под count точек
+void CoordinatesTable::Reserve(size_t count) {
+    lat_.reserve(count);
+    lng_.reserve(count);
+    sin_lat_.reserve(count);
+    cos_lat_.reserve(count);
+}
+
+// Функция добавления точки (её номер - число точек до добавления)
+void CoordinatesTable::Add(const Coordinate& coordinate) {
+    static const double dr = DEG_TO_RAD;
+
+    lat_.push_back(coordinate.lat);
+    lng_.push_back(coordinate.lng);
+    sin_lat_.push_back(sin(coordinate.lat * dr));
+    cos_lat_.push_back(cos(coordinate.lat * dr));
+}
+
+// Функция получения числа точек
+size_t CoordinatesTable::GetSize() const {
+    return lat_.size();
+}
+
+// Функция вычисления count расстояний: result[i] - расстояние от точки from[i] до точки to[i]
+void CoordinatesTable::ComputeDistances(const uint32_t* from, const uint32_t* to, size_t count, double* result) const {
+    using namespace detail;
+
+    static const double dr = DEG_TO_RAD;
+
+    // Промежуточные значения блока в непрерывных массивах: циклы по ним без ветвлений векторизуются
+    double sin_product[BLOCK_SIZE];
+    double cos_product[BLOCK_SIZE];
+    double delta_lng[BLOCK_SIZE];
+    bool   same_point[BLOCK_SIZE];
+
+    for (size_t begin = 0; begin < count; begin += BLOCK_SIZE) {
+        const size_t size = min(BLOCK_SIZE, count - begin);
+
+        // Сбор значений по номерам точек
+        for (size_t i = 0; i < size; ++i) {
+            const uint32_t a = from[begin + i];
+            const uint32_t b = to[begin + i];
+
+            sin_product[i] = sin_lat_[a] * sin_lat_[b];
+            cos_product[i] = cos_lat_[a] * cos_lat_[b];
+            delta_lng[i]   = abs(lng_[a] - lng_[b]) * dr;
+            same_point[i]  = lat_[a] == lat_[b] && lng_[a] == lng_[b];
+        }
+
+        for (size_t i = 0; i < size; ++i) {
+            delta_lng[i] = cos(delta_lng[i]);
+        }
+
+        for (size_t i = 0; i < size; ++i) {
+            result[begin + i] = sin_product[i] + cos_product[i] * delta_lng[i];
+        }
+
+        for (size_t i = 0; i < size; ++i) {
+            result[begin + i] = same_point[i] ? 0.0 : acos(result[begin + i]) * EARTH_RADIUS;
+        }
+    }
+}
+
+// Функция вычисления длины ломаной, проходящей через точки path[0], path[1], ..., path[count - 1]
+// (отрезки суммируются по порядку, как при последовательных вызовах ComputeDistance)
+double CoordinatesTable::ComputePathLength(const uint32_t* path, size_t count) const {
+    using namespace detail;
+
+    double length = 0.0;
+    double distances[BLOCK_SIZE];
+
+    for (size_t begin = 0; begin + 1 < count; begin += BLOCK_SIZE) {
+        const size_t size = min(BLOCK_SIZE, count - 1 - begin);
+
+        ComputeDistances(path + begin, path + begin + 1, size, distances);
+
+        for (size_t i = 0; i < size; ++i) {
+            length += distances[i];
+        }
+    }
+
+    return length;
 }
 
 }
\ No newline at end of file
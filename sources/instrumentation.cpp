@@ -0,0 +1,150 @@
+#include "instrumentation.h"
+
+#ifdef TRANSPORT_CATALOGUE_INSTRUMENTATION
+
+#include <atomic>
+#include <array>
+#include <fstream>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с измерением времени работы этапов обработки запросов
+namespace instrumentation {
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue::instrumentation
+namespace detail {
+
+// Структура накопленной статистики этапа
+struct PhaseStats {
+    atomic<uint64_t> count       = 0; // Число замеров
+    atomic<uint64_t> nanoseconds = 0; // Суммарное время
+    atomic<uint64_t> allocations = 0; // Суммарное число выделений памяти
+};
+
+array<PhaseStats, static_cast<size_t>(Phase::Count)> phases;
+
+atomic<uint64_t> allocations_count = 0; // Число выделений памяти во всех потоках
+atomic<uint64_t> allocations_bytes = 0; // Объём выделенной памяти во всех потоках
+
+// Число выделений памяти в текущем потоке (нужно для замеров этапов без синхронизации)
+thread_local uint64_t thread_allocations = 0;
+
+// Названия этапов в выводе статистики
+constexpr string_view PHASE_NAMES[] = {
+    "json_parse"sv, "base_requests"sv, "set_data"sv, "update_data"sv, "freeze"sv, "router_build"sv, "spatial_index_build"sv,
+    "stat_requests"sv, "stat_stop"sv, "stat_bus"sv, "stat_map"sv, "stat_route"sv, "stat_nearby"sv,
+    "render_map"sv, "print"sv
+};
+
+static_assert(size(PHASE_NAMES) == static_cast<size_t>(Phase::Count));
+
+// Функция учёта выделения памяти
+void CountAllocation(size_t size) noexcept {
+    ++thread_allocations;
+    allocations_count.fetch_add(1, memory_order_relaxed);
+    allocations_bytes.fetch_add(size, memory_order_relaxed);
+}
+
+}
+
+ScopedPhase::ScopedPhase(Phase phase) : phase_(phase),
+                                        start_(chrono::steady_clock::now()),
+                                        allocations_(detail::thread_allocations) { }
+
+ScopedPhase::~ScopedPhase() {
+    const auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start_).count();
+
+    auto& stats = detail::phases[static_cast<size_t>(phase_)];
+    stats.count.fetch_add(1, memory_order_relaxed);
+    stats.nanoseconds.fetch_add(static_cast<uint64_t>(elapsed), memory_order_relaxed);
+    stats.allocations.fetch_add(detail::thread_allocations - allocations_, memory_order_relaxed);
+}
+
+// Функция сброса накопленной статистики
+void Reset() {
+    for (auto& stats : detail::phases) {
+        stats.count = 0;
+        stats.nanoseconds = 0;
+        stats.allocations = 0;
+    }
+
+    detail::allocations_count = 0;
+    detail::allocations_bytes = 0;
+}
+
+// Функция вывода накопленной статистики в формате JSON
+void WriteSummary(ostream& output) {
+    using namespace detail;
+
+    // Снимок счётчиков делается до вывода, чтобы не учитывать выделения памяти самим выводом
+    const uint64_t total_count = allocations_count;
+    const uint64_t total_bytes = allocations_bytes;
+
+    output << "{\"allocations\":{\"count\":"sv << total_count << ",\"bytes\":"sv << total_bytes << "},\"phases\":{"sv;
+
+    bool first = true;
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const uint64_t count = phases[i].count;
+        if (count == 0) continue;
+
+        if (!first) output << ',';
+        else        first = false;
+
+        output << '"' << PHASE_NAMES[i] << "\":{\"count\":"sv << count
+               << ",\"time_ms\":"sv << static_cast<double>(phases[i].nanoseconds) / 1e6
+               << ",\"allocations\":"sv << phases[i].allocations << '}';
+    }
+
+    output << "}}"sv << endl;
+}
+
+// Функция вывода накопленной статистики в файл из переменной окружения TRANSPORT_CATALOGUE_METRICS_FILE
+// (если она не задана - в стандартный поток ошибок)
+void EmitSummary() {
+    if (const char* file = getenv("TRANSPORT_CATALOGUE_METRICS_FILE"); file && *file) {
+        ofstream output(file);
+        WriteSummary(output);
+    }
+    else {
+        WriteSummary(cerr);
+    }
+}
+
+}
+
+}
+
+// Замена глобальных операторов выделения памяти для подсчёта выделений
+void* operator new(size_t size) {
+    transport_catalogue::instrumentation::detail::CountAllocation(size);
+    if (void* pointer = malloc(size ? size : 1)) return pointer;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+#endif
\ No newline at end of file
@@ -1,9 +1,23 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <variant>
+#include <exception>
+#include <stdexcept>
+#include <optional>
+#include <deque>
+#include <map>
+#include <iterator>
 #include "json_reader.h"
 #include "json.h"
 #include "map_renderer.h"
+#include "serialization.h"
+#include "catalogue_image.h"
+#include "instrumentation.h"
 
 using namespace std;
 using namespace json;
@@ -18,7 +32,7 @@ namespace json_reader {
 namespace detail {
 
 // Функция парсинга запроса на добавление остановки
-request_handler::AddStopRequest ParseAddStopRequest(const Dict& request) {
+request_handler::AddStopRequest ParseAddStopRequest(const ArenaDict& request) {
 	string_view  name      = request.at("name"s).AsString();
 	const double latitude  = request.at("latitude"s).AsDouble();
 	const double longitude = request.at("longitude"s).AsDouble();
@@ -35,7 +49,7 @@ request_handler::AddStopRequest ParseAddStopRequest(const Dict& request) {
 }
 			
 // Функция парсинга запроса на добавление маршрута
-request_handler::AddBusRequest ParseAddBusRequest(const Dict& request) {
+request_handler::AddBusRequest ParseAddBusRequest(const ArenaDict& request) {
 	string_view        name = request.at("name"s).AsString();
 	const BusRouteType type = request.at("is_roundtrip"s).AsBool() ? BusRouteType::Circle : BusRouteType::Line;
 
@@ -50,11 +64,56 @@ request_handler::AddBusRequest ParseAddBusRequest(const Dict& request) {
 	return { name, type, stops };
 }
 
+// Функция парсинга пакета изменений базы данных. Запросы имеют тот же формат, что и запросы на заполнение базы,
+// а также тип "Distance" (поля from, to и distance). Запрос с полем "action": "remove" удаляет объект
+// (для остановки и маршрута достаточно поля name, для расстояния - полей from и to), а без поля "action"
+// или с "action": "update" - добавляет или заменяет. Другие значения поля "action" - ошибка
+request_handler::UpdateRequests ParseUpdateRequests(const ArenaArray& requests) {
+	request_handler::UpdateRequests update_requests;
+
+	for (const ArenaNode& request_node : requests) {
+		const ArenaDict request = request_node.AsMap();
+
+		const string_view type = request.at("type"s).AsString();
+
+		const ArenaMember* action = request.find("action"s);
+		const string_view action_name = action != request.end() ? action->value.AsString() : "update"sv;
+
+		if (action_name != "update"sv && action_name != "remove"sv) {
+			throw ParsingError("Unknown update action \""s + string(action_name) + "\""s);
+		}
+
+		const bool is_remove = action_name == "remove"sv;
+
+		if (type == "Stop"sv) {
+			if (is_remove) update_requests.remove_stops.push_back(request.at("name"s).AsString());
+			else           update_requests.update_stops.push_back(ParseAddStopRequest(request));
+		}
+		else if (type == "Bus"sv) {
+			if (is_remove) update_requests.remove_buses.push_back(request.at("name"s).AsString());
+			else           update_requests.update_buses.push_back(ParseAddBusRequest(request));
+		}
+		else if (type == "Distance"sv) {
+			const string_view from = request.at("from"s).AsString();
+			const string_view to   = request.at("to"s).AsString();
+
+			if (is_remove) update_requests.remove_distances.push_back({ from, to });
+			else           update_requests.update_distances.push_back({ from, to, request.at("distance"s).AsInt() });
+		}
+		// Неизвестный тип запроса на изменение базы данных
+		else {
+			throw UnknownRequestType("Unknown request type \""s + string(type) + "\""s);
+		}
+	}
+
+	return update_requests;
+}
+
 // Функция парсинга цвета в формате строки/RGB/RGBa
-map_renderer::Color ParseColor(const Node& color) {
+map_renderer::Color ParseColor(const ArenaNode& color) {
 
 	if(color.IsString()) {
-		return color.AsString();
+		return string(color.AsString());
 	}
 	else if(color.IsArray()) {
 		const auto& color_array = color.AsArray();
@@ -76,7 +135,7 @@ map_renderer::Color ParseColor(const Node& color) {
 }
 
 // Функция парсинга настроек отрисовки карты маршрутов
-map_renderer::RenderSettings ParseRenderSettings(const Dict& render_settings) {
+map_renderer::RenderSettings ParseRenderSettings(const ArenaDict& render_settings) {
 
 	map_renderer::RenderSettings settings;
 
@@ -111,134 +170,780 @@ map_renderer::RenderSettings ParseRenderSettings(const Dict& render_settings) {
 	return settings;
 }
 
-// Функция обработки запросов на заполнение базы данных
-void BaseRequestProcessing(request_handler::RequestHandler& request_handler, const Array& base_requests) {
-	using namespace request_handler;
+// Функция парсинга настроек маршрутизации
+transport_router::RoutingSettings ParseRoutingSettings(const ArenaDict& routing_settings) {
+	transport_router::RoutingSettings settings;
 
-	vector<AddStopRequest> add_stop_requests; // Запросы на добавление остановок
-	vector<AddBusRequest>  add_bus_requests;  // Запросы на добавление маршрутов
+	settings.bus_wait_time = routing_settings.at("bus_wait_time"s).AsInt();
+	settings.bus_velocity  = routing_settings.at("bus_velocity"s).AsDouble();
 
-	// Парсинг запросов на заполнение базы данных
-	for (const auto& base_request : base_requests) {
-		const auto& request = base_request.AsMap();
+	return settings;
+}
 
-		// Запрос на добавление остановки
-		if (request.at("type"s).AsString() == "Stop"s) {
-			add_stop_requests.push_back(ParseAddStopRequest(request));
-		}
-		// Запрос на добавление маршрута
-		else if (request.at("type"s).AsString() == "Bus"s) {
-			add_bus_requests.push_back(ParseAddBusRequest(request));
-		}
-		// Неизвестный тип запроса на заполнение базы данных
-		else {
-			throw UnknownRequestType("Unknown request type \""s + request.at("type"s).AsString() + "\""s);
-		}
+// Функция парсинга настроек сериализации
+serialization::SerializationSettings ParseSerializationSettings(const ArenaDict& serialization_settings) {
+	serialization::SerializationSettings settings;
+
+	settings.file = serialization_settings.at("file"s).AsString();
+
+	if (const auto it = serialization_settings.find("image_file"s); it != serialization_settings.end()) {
+		settings.image_file = it->value.AsString();
 	}
 
-	// Обработка запросов на заполнение базы данных
-	request_handler.SetData(add_stop_requests, add_bus_requests);
+	return settings;
+}
+
+// Функция вывода ответа на запрос, объект которого не найден
+void WriteNotFound(Writer& response, int id) {
+	response.StartDict()
+	        .Key("error_message"sv).String("not found"sv)
+	        .Key("request_id"sv).Int(id)
+	        .EndDict();
+}
+
+// Функция вывода ответа на запрос, тип которого не поддерживается источником данных (например, образом базы данных)
+void WriteNotSupported(Writer& response, int id) {
+	response.StartDict()
+	        .Key("error_message"sv).String("not supported"sv)
+	        .Key("request_id"sv).Int(id)
+	        .EndDict();
 }
 
-// Функция парсинга запроса на получение информации об остановке
-Dict ParseGetStopInfoRequest(request_handler::RequestHandler& request_handler, const Dict& request) {
+// Функция обработки запроса на получение информации об остановке (ответ выводится сразу в response).
+// Источник - обработчик запросов или образ базы данных
+template <typename Source>
+void ParseGetStopInfoRequest(const Source& source, const ArenaDict& request, Writer& response) {
 	const int   id   = request.at("id"s).AsInt();
 	string_view name = request.at("name"s).AsString();
 
-	const auto stop_info = request_handler.GetStopInfo(name);
+	const auto stop_info = source.GetStopInfo(name);
 
-	if (stop_info) {
-		Array busses_arr;
-
-		for (string_view bus : stop_info->buses) {
-			busses_arr.push_back(Node(string(bus)));
-		}
-		return Dict{ { "request_id"s, id }, { "buses"s, busses_arr} };
+	if (!stop_info) {
+		WriteNotFound(response, id);
+		return;
 	}
-	else {
-		return Dict{ { "request_id"s, id }, { "error_message"s, "not found"s} };
+
+	// Ключи ответов выводятся в алфавитном порядке, как при выводе Dict
+	response.StartDict().Key("buses"sv).StartArray();
+
+	for (string_view bus : stop_info->buses) {
+		response.String(bus);
 	}
+
+	response.EndArray()
+	        .Key("request_id"sv).Int(id)
+	        .EndDict();
 }
 
-// Функция парсинга запроса на получение информации о маршруте
-Dict ParseGetBusInfoRequest(request_handler::RequestHandler& request_handler, const Dict& request) {
+// Функция обработки запроса на получение информации о маршруте (ответ выводится сразу в response).
+// Источник - обработчик запросов или образ базы данных
+template <typename Source>
+void ParseGetBusInfoRequest(const Source& source, const ArenaDict& request, Writer& response) {
 	const int   id   = request.at("id"s).AsInt();
 	string_view name = request.at("name"s).AsString();
 
-	const auto bus_info = request_handler.GetBusInfo(name);
+	const auto bus_info = source.GetBusInfo(name);
 
-	if (bus_info) {
-		return Dict{ { "request_id"s,        id },
-				     { "stop_count"s,        static_cast<int>(bus_info->stops_number) },
-					 { "unique_stop_count"s, static_cast<int>(bus_info->unique_stops_number) },
-					 { "route_length"s,      bus_info->route_length},
-					 { "curvature"s,         bus_info->curvature} };
-	}
-	else {
-		return Dict{ { "request_id"s, id }, { "error_message"s, "not found"s} };
+	if (!bus_info) {
+		WriteNotFound(response, id);
+		return;
 	}
+
+	response.StartDict()
+	        .Key("curvature"sv).Double(bus_info->curvature)
+	        .Key("request_id"sv).Int(id)
+	        .Key("route_length"sv).Double(bus_info->route_length)
+	        .Key("stop_count"sv).Int(static_cast<int>(bus_info->stops_number))
+	        .Key("unique_stop_count"sv).Int(static_cast<int>(bus_info->unique_stops_number))
+	        .EndDict();
 }
 
-// Функция парсинга запроса на получение карты маршрутов
-Dict ParseGetRouteMapRequest(request_handler::RequestHandler& request_handler, const Dict& request, const Dict& render_settings) {
+// Класс настроек отрисовки карты маршрутов, которые разбираются один раз при первом запросе карты
+// (и только если карта запрошена). Безопасен для использования из нескольких потоков
+class LazyRenderSettings {
+public:
+	explicit LazyRenderSettings(const ArenaNode& render_settings) : render_settings_(&render_settings) { }
+
+	// Настройки, уже разобранные заранее (например, загруженные из бинарной базы данных)
+	explicit LazyRenderSettings(optional<map_renderer::RenderSettings> settings) : settings_(move(settings)) { }
+
+	// Функция получения разобранных настроек отрисовки
+	const map_renderer::RenderSettings& Get() const {
+		call_once(parsed_flag_, [this] {
+			if (settings_) return;
+			if (!render_settings_) throw logic_error("Render settings are not set"s);
+			settings_ = ParseRenderSettings(render_settings_->AsMap());
+		});
+		return *settings_;
+	}
+
+private:
+	const ArenaNode* render_settings_ = nullptr;
+
+	mutable once_flag parsed_flag_;
+	mutable optional<map_renderer::RenderSettings> settings_;
+};
+
+// Функция обработки запроса на получение карты маршрутов (ответ выводится сразу в response)
+void ParseGetRouteMapRequest(const request_handler::RequestHandler& request_handler, const ArenaDict& request, const LazyRenderSettings& render_settings,
+                             Writer& response) {
 
 	const int id = request.at("id"s).AsInt();
 
 	stringstream route_map;
 
-	const auto settings = ParseRenderSettings(render_settings);
-	request_handler.RenderMap(settings, route_map);
+	request_handler.RenderMap(render_settings.Get(), route_map);
+
+	response.StartDict()
+	        .Key("map"sv).String(route_map.str())
+	        .Key("request_id"sv).Int(id)
+	        .EndDict();
+}
+
+// Функция обработки запроса на построение маршрута поездки между остановками (ответ выводится сразу в response)
+void ParseGetRouteRequest(const request_handler::RequestHandler& request_handler, const ArenaDict& request, Writer& response) {
+	const int   id   = request.at("id"s).AsInt();
+	string_view from = request.at("from"s).AsString();
+	string_view to   = request.at("to"s).AsString();
+
+	// Память под элементы маршрута переиспользуется между запросами одного потока
+	thread_local RouteInfo route;
+
+	if (!request_handler.BuildRoute(from, to, route)) {
+		WriteNotFound(response, id);
+		return;
+	}
+
+	response.StartDict().Key("items"sv).StartArray();
+
+	for (const RouteItem& item : route.items) {
+		if (item.type == RouteItemType::Wait) {
+			response.StartDict()
+			        .Key("stop_name"sv).String(item.name)
+			        .Key("time"sv).Double(item.time)
+			        .Key("type"sv).String("Wait"sv)
+			        .EndDict();
+		}
+		else {
+			response.StartDict()
+			        .Key("bus"sv).String(item.name)
+			        .Key("span_count"sv).Int(static_cast<int>(item.span_count))
+			        .Key("time"sv).Double(item.time)
+			        .Key("type"sv).String("Bus"sv)
+			        .EndDict();
+		}
+	}
+
+	response.EndArray()
+	        .Key("request_id"sv).Int(id)
+	        .Key("total_time"sv).Double(route.total_time)
+	        .EndDict();
+}
+
+// Функция обработки запроса на поиск остановок в радиусе от заданной точки (ответ выводится сразу в response)
+void ParseGetNearbyRequest(const request_handler::RequestHandler& request_handler, const ArenaDict& request, Writer& response) {
+	const int    id        = request.at("id"s).AsInt();
+	const double latitude  = request.at("latitude"s).AsDouble();
+	const double longitude = request.at("longitude"s).AsDouble();
+	const double radius    = request.at("radius"s).AsDouble();
+
+	// Память под найденные остановки переиспользуется между запросами одного потока
+	thread_local vector<NearbyStop> nearby_stops;
+
+	request_handler.FindStopsNearby(geo::Coordinate{ latitude, longitude }, radius, nearby_stops);
+
+	response.StartDict()
+	        .Key("request_id"sv).Int(id)
+	        .Key("stops"sv).StartArray();
 
-	return Dict{ { "request_id"s,  id },
-	             { "map"s, route_map.str() }};
+	for (const NearbyStop& stop : nearby_stops) {
+		response.String(stop.name);
+	}
+
+	response.EndArray().EndDict();
+}
+
+// Функция обработки одного запроса к транспортному справочнику (ответ выводится сразу в response)
+void StatRequestProcessing(const request_handler::RequestHandler& request_handler, const ArenaDict& request, const LazyRenderSettings& render_settings,
+                           Writer& response) {
+	const string_view type = request.at("type"s).AsString();
+
+	// Запрос на получение информации об остановке
+	if (type == "Stop"sv) {
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(StatStop);
+		ParseGetStopInfoRequest(request_handler, request, response);
+	}
+	// Запрос на получение информации о маршруте
+	else if (type == "Bus"sv) {
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(StatBus);
+		ParseGetBusInfoRequest(request_handler, request, response);
+	}
+	// Запрос на получение карты маршрутов
+	else if (type == "Map"sv) {
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(StatMap);
+		ParseGetRouteMapRequest(request_handler, request, render_settings, response);
+	}
+	// Запрос на построение маршрута поездки между остановками
+	else if (type == "Route"sv) {
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(StatRoute);
+		ParseGetRouteRequest(request_handler, request, response);
+	}
+	// Запрос на поиск остановок в радиусе от заданной точки
+	else if (type == "Nearby"sv) {
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(StatNearby);
+		ParseGetNearbyRequest(request_handler, request, response);
+	}
+	// Неизвестный тип запроса к транспортному справочнику
+	else {
+		throw UnknownRequestType("Unknown request type \""s + string(type) + "\""s);
+	}
 }
 
-// Функция обработки запросов к транспортному справочнику
-Document StatRequestProcessing(request_handler::RequestHandler& request_handler, const Array& stat_requests, const Dict& render_settings) {
-	Array response_array;
+// Функция обработки одного запроса к образу базы данных (ответ выводится сразу в response).
+// В образе нет графа маршрутов, пространственного индекса и настроек отрисовки, поэтому на запросы
+// Route, Nearby и Map выводится ошибка "not supported"
+void ImageStatRequestProcessing(const catalogue_image::MappedCatalogue& image, const ArenaDict& request, Writer& response) {
+	const string_view type = request.at("type"s).AsString();
 
-	// Обработка запросов к транспортному справочнику
-	for (const auto& stat_request : stat_requests) {
-		const auto& request = stat_request.AsMap();
+	// Запрос на получение информации об остановке
+	if (type == "Stop"sv) {
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(StatStop);
+		ParseGetStopInfoRequest(image, request, response);
+	}
+	// Запрос на получение информации о маршруте
+	else if (type == "Bus"sv) {
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(StatBus);
+		ParseGetBusInfoRequest(image, request, response);
+	}
+	// Запросы, для которых в образе нет данных
+	else if (type == "Map"sv || type == "Route"sv || type == "Nearby"sv) {
+		WriteNotSupported(response, request.at("id"s).AsInt());
+	}
+	// Неизвестный тип запроса к транспортному справочнику
+	else {
+		throw UnknownRequestType("Unknown request type \""s + string(type) + "\""s);
+	}
+}
+
+// Функция параллельной обработки запросов к транспортному справочнику пулом потоков.
+// Потоки забирают запросы по порядку номеров и выводят ответы в собственные буферы, а буферы
+// вставляются в вывод строго в порядке запросов; обработка не убегает вперёд вывода больше чем на окно,
+// поэтому память под ответы ограничена. Каждый запрос обрабатывает process_request(request, response)
+template <typename ProcessRequest>
+void ParallelStatRequestProcessing(const ArenaArray& stat_requests, Writer& responses, const ProcessingSettings& settings, threading::ThreadPool& pool,
+                                   const ProcessRequest& process_request) {
+
+	// Выведенный ответ на запрос либо исключение, возникшее при его обработке
+	using Result = variant<monostate, string, exception_ptr>;
+
+	const size_t threads_count  = pool.GetThreadsCount();
+	const size_t requests_count = stat_requests.size();
+	const size_t window = threads_count * 64u;
+
+	// Ответы готовятся с тем же отступом, с которым они окажутся внутри массива ответов
+	const size_t response_indent = responses.GetChildIndent();
+
+	vector<Result> results(window);  // Кольцевой буфер ответов, ещё не выведенных в поток
+	size_t printed = 0;              // Число выведенных ответов
+	bool stopped = false;            // Флаг досрочной остановки (при ошибке)
+	atomic<size_t> next_request = 0; // Номер следующего необработанного запроса
+	size_t running = threads_count;  // Число задач пула, которые ещё не завершились
+
+	mutex m;
+	condition_variable result_ready;
+	condition_variable window_moved;
+	condition_variable worker_finished;
+
+	auto process = [&] {
+		while (true) {
+			const size_t n = next_request++;
+			if (n >= requests_count) return;
+
+			// Ждём, пока для ответа освободится место в кольцевом буфере
+			{
+				unique_lock lock(m);
+				window_moved.wait(lock, [&] { return stopped || n < printed + window; });
+				if (stopped) return;
+			}
+
+			Result result;
+			try {
+				Writer response(settings.output_format, response_indent);
+				process_request(stat_requests[n].AsMap(), response);
+				result = response.Release();
+			}
+			catch (...) {
+				result = current_exception();
+			}
+
+			{
+				lock_guard lock(m);
+				results[n % window] = move(result);
+			}
+			result_ready.notify_all();
+		}
+	};
+
+	// Задачи пула обращаются к локальным переменным функции, поэтому выход из неё ждёт завершения всех задач
+	for (size_t i = 0; i < threads_count; ++i) {
+		pool.Submit([&] {
+			process();
+
+			lock_guard lock(m);
+			if (--running == 0) worker_finished.notify_all();
+		});
+	}
+
+	// Останавливает и дожидается задачи пула (в том числе при выходе по исключению)
+	auto join_workers = [&] {
+		unique_lock lock(m);
+		stopped = true;
+		window_moved.notify_all();
+		worker_finished.wait(lock, [&] { return running == 0; });
+	};
+
+	try {
+		for (size_t n = 0; n < requests_count; ++n) {
+			Result result;
+			{
+				unique_lock lock(m);
+				result_ready.wait(lock, [&] { return !holds_alternative<monostate>(results[n % window]); });
+				result = move(results[n % window]);
+				results[n % window] = monostate{};
+				++printed;
+			}
+			window_moved.notify_all();
+
+			if (holds_alternative<exception_ptr>(result)) rethrow_exception(get<exception_ptr>(result));
+
+			TRANSPORT_CATALOGUE_SCOPED_PHASE(Print);
+			responses.RawValue(get<string>(result));
+		}
+	}
+	catch (...) {
+		join_workers();
+		throw;
+	}
+
+	join_workers();
+}
+
+// Функция обработки запросов к транспортному справочнику.
+// Ответы не накапливаются: каждый выводится в буфер сразу при обработке своего запроса, а буфер сбрасывается в поток по мере заполнения.
+// Каждый запрос обрабатывает process_request(request, response). Если пул потоков не передан, а обработка параллельная,
+// пул создаётся на время обработки
+template <typename ProcessRequest>
+void StatRequestProcessing(const ArenaArray& stat_requests, ostream& output, const ProcessingSettings& settings, threading::ThreadPool* pool,
+                           const ProcessRequest& process_request) {
+	TRANSPORT_CATALOGUE_SCOPED_PHASE(StatRequests);
+
+	Writer responses(output, settings.output_format);
+	responses.StartArray();
+
+	if (settings.threads_count > 1 && stat_requests.size() > 1) {
+		optional<threading::ThreadPool> own_pool;
+		if (!pool) pool = &own_pool.emplace(settings.threads_count);
+
+		ParallelStatRequestProcessing(stat_requests, responses, settings, *pool, process_request);
+	}
+	else {
+		// Ответ готовится в отдельном буфере, чтобы его вывод учитывался в этапе Print так же, как при параллельной обработке
+		const size_t response_indent = responses.GetChildIndent();
+
+		for (const auto& stat_request : stat_requests) {
+			Writer response(settings.output_format, response_indent);
+			process_request(stat_request.AsMap(), response);
+
+			TRANSPORT_CATALOGUE_SCOPED_PHASE(Print);
+			responses.RawValue(response.Release());
+		}
+	}
+
+	responses.EndArray();
+	responses.Flush();
+}
 
-		// Запрос на получение информации об остановке
+// Функция обработки запросов к транспортному справочнику обработчиком запросов
+void StatRequestProcessing(const request_handler::RequestHandler& request_handler, const ArenaArray& stat_requests, const LazyRenderSettings& lazy_render_settings,
+                           ostream& output, const ProcessingSettings& settings, threading::ThreadPool* pool = nullptr) {
+	StatRequestProcessing(stat_requests, output, settings, pool, [&](const ArenaDict& request, Writer& response) {
+		StatRequestProcessing(request_handler, request, lazy_render_settings, response);
+	});
+}
+
+// Обработчик потокового разбора запросов: каждый запрос на заполнение базы собирается в небольшой узел
+// в арене, которая сбрасывается после его обработки, и сразу передаётся в справочник.
+// Остальные разделы документа собираются целиком в отдельной арене
+class StreamingRequestsHandler final : public SaxHandler {
+public:
+	explicit StreamingRequestsHandler(request_handler::RequestHandler& request_handler) : request_handler_(request_handler) { }
+
+	void Null()                    override { CheckInsideSection(); Builder().Null();        CompleteScalar(); }
+	void Bool(bool value)          override { CheckInsideSection(); Builder().Bool(value);   CompleteScalar(); }
+	void Int(int value)            override { CheckInsideSection(); Builder().Int(value);    CompleteScalar(); }
+	void Double(double value)      override { CheckInsideSection(); Builder().Double(value); CompleteScalar(); }
+	void String(string_view value) override { CheckInsideSection(); Builder().String(value); CompleteScalar(); }
+
+	void StartArray() override {
+		// Начало массива запросов на заполнение базы данных: его элементы обрабатываются по одному
+		if (!nesting_ && depth_ == 1 && section_ == "base_requests"sv) {
+			depth_ = 2;
+			return;
+		}
+
+		CheckInsideSection();
+		Builder().StartArray();
+		++nesting_;
+	}
+
+	void EndArray() override {
+		// Конец массива запросов на заполнение базы данных
+		if (!nesting_ && depth_ == 2) {
+			depth_ = 1;
+			return;
+		}
+
+		Builder().EndArray();
+		Close();
+	}
+
+	void StartDict() override {
+		// Начало корневого словаря документа
+		if (!nesting_ && depth_ == 0) {
+			depth_ = 1;
+			return;
+		}
+
+		CheckInsideSection();
+		Builder().StartDict();
+		++nesting_;
+	}
+
+	void Key(string_view key) override {
+		// Ключ корневого словаря - название раздела документа
+		if (!nesting_ && depth_ == 1) {
+			section_ = key;
+			return;
+		}
+
+		Builder().Key(key);
+	}
+
+	void EndDict() override {
+		// Конец корневого словаря документа
+		if (!nesting_ && depth_ == 1) {
+			depth_ = 0;
+			return;
+		}
+
+		Builder().EndDict();
+		Close();
+	}
+
+	// Функция получения разделов документа, кроме запросов на заполнение базы данных
+	const map<string, ArenaNode, less<>>& GetSections() const {
+		return sections_;
+	}
+
+private:
+	// Функция получения сборщика узла: запросы на заполнение базы собираются во временной арене, разделы - в постоянной
+	ArenaBuilder& Builder() {
+		return depth_ == 2 ? request_builder_ : sections_builder_;
+	}
+
+	// Функция проверки, что значение находится внутри одного из разделов документа
+	void CheckInsideSection() const {
+		if (nesting_ == 0 && depth_ == 0) throw ParsingError("Root of the requests document is not a dictionary"s);
+	}
+
+	// Функция обработки скалярного значения (на уровне раздела оно само является собранным узлом)
+	void CompleteScalar() {
+		if (nesting_ == 0) Complete();
+	}
+
+	// Функция обработки закрытия массива или словаря внутри собираемого узла
+	void Close() {
+		--nesting_;
+		if (nesting_ == 0) Complete();
+	}
+
+	// Функция обработки полностью собранного узла
+	void Complete() {
+		if (depth_ == 2) {
+			ProcessBaseRequest(request_builder_.Extract());
+
+			// Справочник копирует названия себе, поэтому память запроса больше не нужна
+			request_arena_.Reset();
+		}
+		else {
+			sections_.emplace(section_, sections_builder_.Extract());
+		}
+	}
+
+	// Функция обработки одного запроса на заполнение базы данных
+	void ProcessBaseRequest(const ArenaNode& base_request) {
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(BaseRequests);
+
+		const ArenaDict request = base_request.AsMap();
+
+		// Запрос на добавление остановки
 		if (request.at("type"s).AsString() == "Stop"s) {
-			response_array.push_back(Node(ParseGetStopInfoRequest(request_handler, request)));
+			request_handler_.AddStop(ParseAddStopRequest(request));
 		}
-		// Запрос на получение информации о маршруте
+		// Запрос на добавление маршрута
 		else if (request.at("type"s).AsString() == "Bus"s) {
-			response_array.push_back(Node(ParseGetBusInfoRequest(request_handler, request)));
+			request_handler_.AddBus(ParseAddBusRequest(request));
 		}
-		// Запрос на получение карты маршрутов
-		else if (request.at("type"s).AsString() == "Map"s) {
-			response_array.push_back(Node(ParseGetRouteMapRequest(request_handler, request, render_settings)));
-		}
-		// Неизвестный тип запроса к транспортному справочнику
+		// Неизвестный тип запроса на заполнение базы данных
 		else {
-			throw UnknownRequestType("Unknown request type \""s + request.at("type"s).AsString() + "\""s);
+			throw UnknownRequestType("Unknown request type \""s + string(request.at("type"s).AsString()) + "\""s);
 		}
 	}
 
-	// Запаковываем response_array в документ и возвращаем его
-	return Document(response_array);
+	request_handler::RequestHandler& request_handler_;
+
+	Arena request_arena_;             // Арена текущего запроса на заполнение базы данных
+	Arena sections_arena_;            // Арена разделов документа
+	ArenaBuilder request_builder_{ request_arena_ };   // Сборщик запроса на заполнение базы данных
+	ArenaBuilder sections_builder_{ sections_arena_ }; // Сборщик раздела документа
+
+	size_t nesting_ = 0;   // Глубина вложенности внутри собираемого узла
+	size_t depth_   = 0;   // Уровень вне собираемых узлов: 0 - вне документа, 1 - корневой словарь, 2 - массив base_requests
+	string section_;       // Название текущего раздела документа
+
+	map<string, ArenaNode, less<>> sections_; // Собранные разделы документа
+};
+
+
 }
 
+// Функция обработки запросов к транспортному справочнику в формате JSON.
+// Поток читается в память целиком и разбирается так же, как непрерывный буфер
+void RequestProcessing(request_handler::RequestHandler& request_handler, istream& input, ostream& output, const ProcessingSettings& settings) {
+	const string buffer{ istreambuf_iterator<char>(input), istreambuf_iterator<char>() };
+	RequestProcessing(request_handler, string_view(buffer), output, settings);
 }
 
-// Функция обработки запросов к транспортному справочнику в формате JSON
-void RequestProcessing(request_handler::RequestHandler& request_handler, istream& input, ostream& output) {
+// Функция обработки запросов к транспортному справочнику в формате JSON, целиком находящихся в непрерывном буфере.
+// Запросы на заполнение базы данных разбираются потоково и сразу попадают в справочник, не образуя DOM
+void RequestProcessing(request_handler::RequestHandler& request_handler, string_view input, ostream& output, const ProcessingSettings& settings) {
 	using namespace detail;
-	using namespace request_handler;
 
-	const Document requests(input);
-	const auto& base_requests   = requests.GetRoot().AsMap().at("base_requests"s).AsArray();
-	const auto& stat_requests   = requests.GetRoot().AsMap().at("stat_requests"s).AsArray();
-	const auto& render_settings = requests.GetRoot().AsMap().at("render_settings"s).AsMap();
+	TRANSPORT_CATALOGUE_RESET_METRICS();
+
+	// Запросы на заполнение базы обрабатываются прямо во время разбора, поэтому их время входит и в разбор
+	StreamingRequestsHandler handler(request_handler);
+	{
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(JsonParse);
+		ParseSax(input, handler);
+	}
+
+	const auto& sections = handler.GetSections();
+
+	// Настройки маршрутизации нужны до завершения заполнения базы: граф маршрутов строится сразу после него
+	if (const auto it = sections.find("routing_settings"s); it != sections.end()) {
+		request_handler.SetRoutingSettings(ParseRoutingSettings(it->second.AsMap()));
+	}
+
+	request_handler.CompleteData();
+
+	// Изменения применяются к уже замороженной базе
+	if (const auto it = sections.find("update_requests"s); it != sections.end()) {
+		request_handler.UpdateData(ParseUpdateRequests(it->second.AsArray()));
+	}
+
+	const ArenaArray stat_requests  = sections.at("stat_requests"s).AsArray();
+	const auto& render_settings     = sections.at("render_settings"s);
+
+	StatRequestProcessing(request_handler, stat_requests, LazyRenderSettings(render_settings), output, settings);
+
+	TRANSPORT_CATALOGUE_EMIT_METRICS();
+}
+
+// Функция создания бинарной базы данных по запросам на заполнение базы в формате JSON (режим make_base).
+// Кроме запросов на заполнение базы в файл сохраняются настройки отрисовки карты и маршрутизации
+void MakeBase(request_handler::RequestHandler& request_handler, string_view input) {
+	using namespace detail;
+
+	StreamingRequestsHandler handler(request_handler);
+	ParseSax(input, handler);
+
+	// Заморозка проверяет целостность базы до её сохранения
+	request_handler.CompleteData();
+
+	const auto& sections = handler.GetSections();
+
+	serialization::BaseSettings base_settings;
+
+	if (const auto it = sections.find("render_settings"s); it != sections.end()) {
+		base_settings.render_settings = ParseRenderSettings(it->second.AsMap());
+	}
+
+	// Граф маршрутов в режиме make_base не строится: настройки только сохраняются в файл
+	if (const auto it = sections.find("routing_settings"s); it != sections.end()) {
+		base_settings.routing_settings = ParseRoutingSettings(it->second.AsMap());
+	}
+
+	request_handler.SaveBase(ParseSerializationSettings(sections.at("serialization_settings"s).AsMap()), base_settings);
+}
+
+// Функция обработки запросов к справочнику, база данных которого загружается из бинарного файла (режим process_requests)
+void ProcessRequests(request_handler::RequestHandler& request_handler, string_view input, ostream& output, const ProcessingSettings& settings) {
+	using namespace detail;
+
+	TRANSPORT_CATALOGUE_RESET_METRICS();
+
+	optional<ArenaDocument> requests;
+	{
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(JsonParse);
+		requests.emplace(input);
+	}
+
+	const ArenaDict root = requests->GetRoot().AsMap();
+
+	serialization::BaseSettings base_settings = request_handler.LoadBase(ParseSerializationSettings(root.at("serialization_settings"s).AsMap()));
+
+	// Изменения применяются к загруженной базе и в файл не сохраняются
+	if (const ArenaMember* update_requests = root.find("update_requests"s); update_requests != root.end()) {
+		request_handler.UpdateData(ParseUpdateRequests(update_requests->value.AsArray()));
+	}
+
+	StatRequestProcessing(request_handler, root.at("stat_requests"s).AsArray(), LazyRenderSettings(move(base_settings.render_settings)), output, settings);
+
+	TRANSPORT_CATALOGUE_EMIT_METRICS();
+}
+
+BatchProcessor::BatchProcessor(const versioning::VersionedCatalogue& catalogue, const ProcessingSettings& settings) : catalogue_(&catalogue),
+                                                                                                                   settings_(settings) {
+	// Ответ на пакет выводится одной строкой
+	settings_.output_format = PrintFormat::Compact;
+
+	if (settings_.threads_count > 1) {
+		pool_ = make_unique<threading::ThreadPool>(settings_.threads_count);
+	}
+}
+
+BatchProcessor::BatchProcessor(const catalogue_image::MappedCatalogue& image, const ProcessingSettings& settings) : image_(&image),
+                                                                                                                 settings_(settings) {
+	// Ответ на пакет выводится одной строкой
+	settings_.output_format = PrintFormat::Compact;
+
+	if (settings_.threads_count > 1) {
+		pool_ = make_unique<threading::ThreadPool>(settings_.threads_count);
+	}
+}
+
+// Функция обработки потока пакетов запросов: каждая непустая строка input - документ с массивом stat_requests,
+// ответ на него - одна строка output. Следующие пакеты читаются и разбираются отдельным потоком
+// параллельно с обработкой текущего пакета. Ошибка в пакете не прерывает обработку следующих пакетов
+void BatchProcessor::Process(istream& input, ostream& output, const function<void()>& close_input) const {
+	using namespace detail;
+
+	// Разобранный пакет, сообщение об ошибке его разбора или признак конца входного потока
+	using Batch = variant<monostate, ArenaDocument, string>;
+
+	// Число пакетов, которые могут быть разобраны заранее
+	constexpr size_t max_ready_batches = 2;
+
+	deque<Batch> batches;
+	bool stopped = false;
+
+	mutex m;
+	condition_variable batch_ready;
+	condition_variable batch_taken;
+
+	auto push = [&](Batch batch) {
+		unique_lock lock(m);
+		batch_taken.wait(lock, [&] { return stopped || batches.size() < max_ready_batches; });
+		if (stopped) return false;
+		batches.push_back(move(batch));
+		batch_ready.notify_one();
+		return true;
+	};
+
+	thread reader([&] {
+		string line;
+		while (getline(input, line)) {
+			if (line.find_first_not_of(" \t\r"sv) == string::npos) continue;
+
+			Batch batch;
+			try {
+				TRANSPORT_CATALOGUE_SCOPED_PHASE(JsonParse);
+				batch = ArenaDocument(line);
+			}
+			catch (const exception& e) {
+				batch = string(e.what());
+			}
+
+			if (!push(move(batch))) return;
+		}
+		push(monostate{});
+	});
+
+	bool input_ended = false; // Входной поток прочитан до конца
+
+	auto print_error = [&output](string message) {
+		Document(Dict{ { "error_message"s, move(message) } }).Print(output, PrintFormat::Compact);
+	};
+
+	while (true) {
+		Batch batch;
+		{
+			unique_lock lock(m);
+			batch_ready.wait(lock, [&] { return !batches.empty(); });
+			batch = move(batches.front());
+			batches.pop_front();
+		}
+		batch_taken.notify_one();
+
+		if (holds_alternative<monostate>(batch)) {
+			input_ended = true;
+			break;
+		}
+
+		if (holds_alternative<string>(batch)) {
+			print_error(move(get<string>(batch)));
+		}
+		else {
+			// Ответы выводятся в строковый буфер, чтобы при ошибке в середине пакета не вывести половину строки
+			ostringstream responses;
+			try {
+				const ArenaArray stat_requests = get<ArenaDocument>(batch).GetRoot().AsMap().at("stat_requests"s).AsArray();
+
+				if (image_) {
+					StatRequestProcessing(stat_requests, responses, settings_, pool_.get(), [this](const ArenaDict& request, Writer& response) {
+						ImageStatRequestProcessing(*image_, request, response);
+					});
+				}
+				else {
+					// Снимок базы закрепляется на время пакета: опубликованная в это время версия достанется следующим пакетам
+					const auto snapshot = catalogue_->Pin();
+					StatRequestProcessing(snapshot->handler, stat_requests, LazyRenderSettings(snapshot->render_settings), responses, settings_, pool_.get());
+				}
+				output << responses.str();
+			}
+			catch (const exception& e) {
+				print_error(e.what());
+			}
+		}
+
+		output << '\n';
+		output.flush();
+
+		// Получатель ответов отключился: дальше обрабатывать пакеты незачем
+		if (!output) break;
+	}
+
+	{
+		lock_guard lock(m);
+		stopped = true;
+	}
+	batch_taken.notify_all();
 
-	BaseRequestProcessing(request_handler, base_requests);
+	// Вывод оборвался, а поток разбора может ждать следующий пакет во входном потоке, который клиент не закрывает
+	if (!input_ended && close_input) close_input();
 
-	const Document stat_responses = StatRequestProcessing(request_handler, stat_requests, render_settings);
-	stat_responses.Print(output);
+	reader.join();
 }
 
 }
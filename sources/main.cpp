@@ -1,12 +1,54 @@
 #include <iostream>
 #include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <algorithm>
+#include <functional>
 #include "transport_catalogue.h"
 #include "request_handler.h"
 #include "map_renderer.h"
 #include "json_reader.h"
+#include "json.h"
+#include "server.h"
+#include "catalogue_versions.h"
+#include "catalogue_image.h"
+#include "instrumentation.h"
 using namespace std;
 
-int main() {
+// Функция вывода подсказки по режимам запуска программы
+void PrintUsage(ostream& stream = cerr) {
+	stream << "Usage: transport_catalogue [make_base|process_requests|serve BASE_FILE [SOCKET_PATH]|serve --image IMAGE_FILE [SOCKET_PATH]]\n"sv;
+	stream << "  without arguments  - read input.json and write output.json\n"sv;
+	stream << "  make_base          - read base requests from stdin and save the base to serialization_settings.file\n"sv;
+	stream << "  process_requests   - load the base from serialization_settings.file and answer stat requests from stdin\n"sv;
+	stream << "  serve              - load the base from BASE_FILE once and answer newline-delimited stat request batches\n"sv;
+	stream << "                       from stdin (or from connections to the Unix socket SOCKET_PATH), one response line per batch;\n"sv;
+	stream << "                       SIGHUP reloads BASE_FILE without interrupting request processing,\n"sv;
+	stream << "                       SIGUSR1 writes per-phase metrics collected since the previous SIGUSR1 (instrumented builds)\n"sv;
+	stream << "  serve --image      - the same, but answer Stop and Bus requests straight from the memory-mapped image IMAGE_FILE\n"sv;
+	stream << "                       (serialization_settings.image_file) without loading it; other requests get \"not supported\"\n"sv;
+}
+
+// Функция запуска обработчика пакетов запросов: из стандартного потока или из соединений с Unix-сокетом socket_path
+void ServeBatches(const transport_catalogue::json_reader::BatchProcessor& processor, const char* socket_path) {
+	if (socket_path) {
+		transport_catalogue::server::ServeUnixSocket(socket_path, [&processor](istream& input, ostream& output, const function<void()>& close_input) {
+			processor.Process(input, output, close_input);
+		});
+	}
+	else {
+		processor.Process(cin, cout);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc > 5) {
+		PrintUsage();
+		return 1;
+	}
+
 	// Создаём транспортный справочник
 	transport_catalogue::TransportCatalogue catalogue;
 
@@ -16,11 +58,110 @@ int main() {
 	// Создаём обработчик запросов к транспортному справочнику
 	transport_catalogue::request_handler::RequestHandler request_handler(catalogue, renderer);
 
-	ifstream input("input.json");
-	ofstream output("output.json");
+	// Запросы к справочнику обрабатываются параллельно на всех доступных ядрах
+	transport_catalogue::json_reader::ProcessingSettings settings;
+	settings.threads_count = max(1u, thread::hardware_concurrency());
+
+	if (argc == 1) {
+		// Входной файл отображается в память и разбирается прямо из буфера
+		const json::MappedFile input("input.json");
+		ofstream output("output.json");
+
+		// Читаем и обрабатываем запросы в формате JSON
+		transport_catalogue::json_reader::RequestProcessing(request_handler, input.GetData(), output, settings);
+
+		return 0;
+	}
+
+	const string_view mode(argv[1]);
+
+	if (mode == "serve"sv && argc >= 4 && argv[2] == "--image"sv) {
+		// Образ не загружается, а отображается в память, поэтому он не перезагружается по SIGHUP:
+		// достаточно перезапустить процесс, и новый файл окажется в памяти без разбора
+		const transport_catalogue::catalogue_image::MappedCatalogue image(argv[3]);
+
+		transport_catalogue::server::SignalHandlers signal_handlers;
+		signal_handlers.dump_metrics = [] {
+			TRANSPORT_CATALOGUE_EMIT_METRICS();
+			TRANSPORT_CATALOGUE_RESET_METRICS();
+		};
+
+		const transport_catalogue::server::SignalListener signal_listener(move(signal_handlers));
+
+		const transport_catalogue::json_reader::BatchProcessor processor(image, settings);
+
+		ServeBatches(processor, argc == 5 ? argv[4] : nullptr);
+
+		return 0;
+	}
+
+	if (argc > 4) {
+		PrintUsage();
+		return 1;
+	}
+
+	if (mode == "serve"sv && argc >= 3) {
+		using namespace transport_catalogue::versioning;
+
+		transport_catalogue::serialization::SerializationSettings serialization_settings;
+		serialization_settings.file = argv[2];
+
+		VersionedCatalogue versions(LoadSnapshot(serialization_settings));
+
+		transport_catalogue::server::SignalHandlers signal_handlers;
+
+		// По сигналу SIGHUP база загружается заново рядом с текущей и подменяет её: пакеты, которые уже обрабатываются,
+		// дорабатывают по старой версии, а она удаляется, когда последний из них завершится
+		signal_handlers.reload = [&versions, &serialization_settings] {
+			try {
+				const uint64_t version = versions.Publish(LoadSnapshot(serialization_settings));
+				cerr << "Base reloaded, version "sv << version << endl;
+			}
+			catch (const exception& e) {
+				cerr << "Base reload failed: "sv << e.what() << endl;
+			}
+
+			versions.ReclaimAll();
+		};
+
+		// Сервер не завершается, поэтому статистика этапов выводится по сигналу SIGUSR1 и сразу сбрасывается:
+		// каждая сводка описывает пакеты, обработанные с предыдущего сигнала
+		signal_handlers.dump_metrics = [] {
+			TRANSPORT_CATALOGUE_EMIT_METRICS();
+			TRANSPORT_CATALOGUE_RESET_METRICS();
+		};
+
+		// Поток сигналов останавливается при выходе раньше, чем удаляется versions
+		const transport_catalogue::server::SignalListener signal_listener(move(signal_handlers));
+
+		const transport_catalogue::json_reader::BatchProcessor processor(versions, settings);
+
+		ServeBatches(processor, argc == 4 ? argv[3] : nullptr);
+
+		return 0;
+	}
+
+	if (argc > 2) {
+		PrintUsage();
+		return 1;
+	}
+
+	if (mode == "make_base"sv) {
+		const string input(istreambuf_iterator<char>(cin), {});
+
+		// Заполняем базу и сохраняем её в бинарный файл
+		transport_catalogue::json_reader::MakeBase(request_handler, input);
+	}
+	else if (mode == "process_requests"sv) {
+		const string input(istreambuf_iterator<char>(cin), {});
 
-	// Читаем и обрабатываем запросы в формате JSON
-	transport_catalogue::json_reader::RequestProcessing(request_handler, input, output);
+		// Загружаем базу из бинарного файла и отвечаем на запросы
+		transport_catalogue::json_reader::ProcessRequests(request_handler, input, cout, settings);
+	}
+	else {
+		PrintUsage();
+		return 1;
+	}
 
 	return 0;
 }
\ No newline at end of file
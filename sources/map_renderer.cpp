@@ -1,4 +1,5 @@
 #include "map_renderer.h"
+#include "instrumentation.h"
 using namespace std;
 using namespace svg;
 using namespace geo;
@@ -26,33 +27,48 @@ Point SphereProjector::operator()(Coordinate coordinate) const {
 
 }
 
+bool operator == (const RenderSettings& lhs, const RenderSettings& rhs) {
+    return lhs.width                == rhs.width                &&
+           lhs.height               == rhs.height               &&
+           lhs.padding              == rhs.padding              &&
+           lhs.line_width           == rhs.line_width           &&
+           lhs.stop_radius          == rhs.stop_radius          &&
+           lhs.bus_label_font_size  == rhs.bus_label_font_size  &&
+           lhs.bus_label_offset     == rhs.bus_label_offset     &&
+           lhs.stop_label_font_size == rhs.stop_label_font_size &&
+           lhs.stop_label_offset    == rhs.stop_label_offset    &&
+           lhs.underlayer_color     == rhs.underlayer_color     &&
+           lhs.underlayer_width     == rhs.underlayer_width     &&
+           lhs.color_palette        == rhs.color_palette;
+}
+
+bool operator != (const RenderSettings& lhs, const RenderSettings& rhs) {
+    return !(lhs == rhs);
+}
+
 MapRenderer::MapRenderer(const TransportCatalogue& catalogue) : catalogue_(catalogue) { }
 
 // Функция отрисовки линий маршрутов на карте маршрутов
-void MapRenderer::RenderRoutesPaths(Document& document, const detail::SphereProjector& projector, const RenderSettings& settings) const{
+void MapRenderer::RenderRoutesPaths(FlatDocument& document, const detail::RenderModel& model, const RenderSettings& settings) const{
 
     // Счётчик для использования цветов из палитры цветов по кругу
     size_t color_counter = 0;
     
-    // Проходим по всем маршрутам в алфавитном порядке
-    for(const auto& [bus_name, bus] : catalogue_.GetBusnameToBusMap()) {
-        
-        // Если на маршруте нет остановок, то пропускаем его
-        if(bus->stops.empty()) continue;
+    // Проходим по всем непустым маршрутам в алфавитном порядке
+    for(const BusId bus_id : model.buses) {
+        const Bus& bus = catalogue_.GetBus(bus_id);
 
         // Формируем линию очередного маршрута
         Polyline route;
 
-        for(const auto& stop : bus->stops) {
-            route.AddPoint(projector(stop->coordinate));
+        for(const StopId stop_id : bus.stops) {
+            route.AddPoint(model.stop_points[stop_id]);
         }
 
         // Если маршрут линейный, нужно отрисовать и обратный путь
-        if(bus->type == BusRouteType::Line) {
-            bool last = true;
-            for(auto stop_it = bus->stops.rbegin(); stop_it != bus->stops.rend(); ++stop_it) {
-                if (last) { last = false; continue; }
-                route.AddPoint(projector((*stop_it)->coordinate));
+        if(bus.type == BusRouteType::Line) {
+            for(auto stop_it = next(bus.stops.rbegin()); stop_it != bus.stops.rend(); ++stop_it) {
+                route.AddPoint(model.stop_points[*stop_it]);
             }
         }
 
@@ -71,31 +87,30 @@ void MapRenderer::RenderRoutesPaths(Document& document, const detail::SphereProj
 }
 
 // Функция отрисовки названий маршрутов на карте маршрутов
-void MapRenderer::RenderRoutesNames(Document& document, const detail::SphereProjector& projector, const RenderSettings& settings) const{
+void MapRenderer::RenderRoutesNames(FlatDocument& document, const detail::RenderModel& model, const RenderSettings& settings) const{
 
     // Счётчик для использования цветов из палитры цветов по кругу
     size_t color_counter = 0;
 
-    // Проходим по всем маршрутам в алфавитном порядке
-    for(const auto& [bus_name, bus] : catalogue_.GetBusnameToBusMap()) {
-
-        // Если на маршруте нет остановок, то пропускаем его
-        if(bus->stops.empty()) continue;
+    // Проходим по всем непустым маршрутам в алфавитном порядке
+    for(const BusId bus_id : model.buses) {
+        const Bus& bus = catalogue_.GetBus(bus_id);
+        const string bus_name(bus.name);
 
         // Формируем название очередного маршрута и подложку для него
         Text route_name_text;
         Text route_name_text_underlayer;
 
-        route_name_text.SetPosition(projector(bus->stops[0]->coordinate))
-                       .SetData(string(bus_name))
+        route_name_text.SetPosition(model.stop_points[bus.stops.front()])
+                       .SetData(bus_name)
                        .SetOffset(settings.bus_label_offset)
                        .SetFontSize(settings.bus_label_font_size)
                        .SetFontFamily("Verdana"s)
                        .SetFontWeight("bold"s)
                        .SetFillColor(settings.color_palette[color_counter]);
         
-        route_name_text_underlayer.SetPosition(projector(bus->stops[0]->coordinate))
-                                  .SetData(string(bus_name))
+        route_name_text_underlayer.SetPosition(model.stop_points[bus.stops.front()])
+                                  .SetData(bus_name)
                                   .SetOffset(settings.bus_label_offset)
                                   .SetFontSize(settings.bus_label_font_size)
                                   .SetFontFamily("Verdana"s)
@@ -111,10 +126,10 @@ void MapRenderer::RenderRoutesNames(Document& document, const detail::SphereProj
         document.Add(route_name_text);
 
         // Если маршрут линейный, нужно отрисовать название и подложку у конечной остановки
-        if(bus->type == BusRouteType::Line) {
+        if(bus.type == BusRouteType::Line) {
 
-            route_name_text.SetPosition(projector(bus->stops.back()->coordinate));
-            route_name_text_underlayer.SetPosition(projector(bus->stops.back()->coordinate));
+            route_name_text.SetPosition(model.stop_points[bus.stops.back()]);
+            route_name_text_underlayer.SetPosition(model.stop_points[bus.stops.back()]);
 
             document.Add(route_name_text_underlayer);
             document.Add(route_name_text);
@@ -126,18 +141,15 @@ void MapRenderer::RenderRoutesNames(Document& document, const detail::SphereProj
 }
 
 // Функция отрисовки точек остановок на карте маршрутов
-void MapRenderer::RenderRoutesStopsPoints(Document& document, const detail::SphereProjector& projector, const RenderSettings& settings) const{
+void MapRenderer::RenderRoutesStopsPoints(FlatDocument& document, const detail::RenderModel& model, const RenderSettings& settings) const{
 
-    // Проходим по всем остановкам в алфавитном порядке
-    for(const auto& [stop_name, stop] : catalogue_.GetStopnameToStopMap()) {
-
-        // Если через остановку не проходят маршруты, то пропускаем её
-        if(!catalogue_.IfBusesOnStop(stop_name)) continue;
+    // Проходим по всем остановкам, через которые проходят маршруты, в алфавитном порядке
+    for(const StopId stop_id : model.stops) {
 
         // Формируем точку очередной остановки
         Circle stop_point;
 
-        stop_point.SetCenter(projector(stop->coordinate))
+        stop_point.SetCenter(model.stop_points[stop_id])
                   .SetRadius(settings.stop_radius)
                   .SetFillColor("white"s);
         
@@ -147,27 +159,26 @@ void MapRenderer::RenderRoutesStopsPoints(Document& document, const detail::Sphe
 }
 
 // Функция отрисовки названий остановок на карте маршрутов
-void MapRenderer::RenderRoutesStopsNames(Document& document, const detail::SphereProjector& projector, const RenderSettings& settings) const{
-
-    // Проходим по всем остановкам в алфавитном порядке
-    for(const auto& [stop_name, stop] : catalogue_.GetStopnameToStopMap()) {
+void MapRenderer::RenderRoutesStopsNames(FlatDocument& document, const detail::RenderModel& model, const RenderSettings& settings) const{
 
-        // Если через остановку не проходят маршруты, то пропускаем её
-        if(!catalogue_.IfBusesOnStop(stop_name)) continue;
+    // Проходим по всем остановкам, через которые проходят маршруты, в алфавитном порядке
+    for(const StopId stop_id : model.stops) {
 
         // Формируем название очередной остановки и подложку для него
         Text stop_name_text;
         Text stop_name_text_underlayer;
 
-        stop_name_text.SetPosition(projector(stop->coordinate))
-                       .SetData(string(stop_name))
+        const string stop_name(catalogue_.GetStop(stop_id).name);
+
+        stop_name_text.SetPosition(model.stop_points[stop_id])
+                       .SetData(stop_name)
                        .SetOffset(settings.stop_label_offset)
                        .SetFontSize(settings.stop_label_font_size)
                        .SetFontFamily("Verdana"s)
                        .SetFillColor("black"s);
         
-        stop_name_text_underlayer.SetPosition(projector(stop->coordinate))
-                                 .SetData(string(stop_name))
+        stop_name_text_underlayer.SetPosition(model.stop_points[stop_id])
+                                 .SetData(stop_name)
                                  .SetOffset(settings.stop_label_offset)
                                  .SetFontSize(settings.stop_label_font_size)
                                  .SetFontFamily("Verdana"s)
@@ -183,32 +194,116 @@ void MapRenderer::RenderRoutesStopsNames(Document& document, const detail::Spher
     }
 }
 
-// Функция отрисовки карты маршрутов
+// Функция отрисовки карты маршрутов. Результат запоминается и выводится повторно без отрисовки,
+// пока не изменятся настройки отрисовки или справочник. Безопасна для вызова из нескольких потоков
 void MapRenderer::RenderMap(const RenderSettings& settings, ostream& output) const {
+    TRANSPORT_CATALOGUE_SCOPED_PHASE(RenderMap);
+
+    shared_ptr<const RenderedMap> rendered_map;
+
+    {
+        lock_guard lock(cache_mutex_);
+
+        const uint64_t catalogue_version = catalogue_.GetVersion();
+
+        // Если запомненной карты нет или она устарела, отрисовываем карту заново
+        if (!cached_map_ || cached_map_->catalogue_version != catalogue_version || cached_map_->settings != settings) {
+            cached_map_ = make_shared<const RenderedMap>(RenderedMap{ settings, catalogue_version, RenderMapDocument(settings) });
+        }
+
+        rendered_map = cached_map_;
+    }
+
+    // Вывод в поток происходит вне блокировки: запомненная карта неизменяемая
+    output << rendered_map->svg;
+}
+
+// Функция получения модели отрисовки (модель перестраивается, только если изменился справочник или размеры карты)
+const detail::RenderModel& MapRenderer::GetRenderModel(const RenderSettings& settings) const {
     using namespace detail;
 
-    // SVG-документ с картой маршрутов
-    Document result;
+    const uint64_t catalogue_version = catalogue_.GetVersion();
+
+    if (render_model_ && render_model_->catalogue_version == catalogue_version && render_model_->width == settings.width
+                      && render_model_->height == settings.height && render_model_->padding == settings.padding) {
+        return *render_model_;
+    }
+
+    RenderModel model;
+    model.catalogue_version = catalogue_version;
+    model.width   = settings.width;
+    model.height  = settings.height;
+    model.padding = settings.padding;
 
-    // Создаём проектор сферических координат на карту
-    const SphereProjector projector(catalogue_.GetStops().begin(),
-                                    catalogue_.GetStops().end(),
-                                    settings.width, settings.height, settings.padding);
+    const auto& stops = catalogue_.GetStops();
+    const auto& buses = catalogue_.GetBuses();
+
+    // Непустые маршруты (если маршрут с тем же названием добавлялся повторно, берётся последний)
+    for (BusId bus_id = 0; bus_id < buses.size(); ++bus_id) {
+        if (!buses[bus_id].stops.empty() && catalogue_.FindBusId(buses[bus_id].name) == bus_id) {
+            model.buses.push_back(bus_id);
+        }
+    }
+
+    sort(model.buses.begin(), model.buses.end(), [&buses](BusId lhs, BusId rhs) { return buses[lhs].name < buses[rhs].name; });
+
+    // Остановки, через которые проходят маршруты
+    for (StopId stop_id = 0; stop_id < stops.size(); ++stop_id) {
+        if (catalogue_.IfBusesOnStop(stop_id)) {
+            model.stops.push_back(stop_id);
+        }
+    }
+
+    sort(model.stops.begin(), model.stops.end(), [&stops](StopId lhs, StopId rhs) { return stops[lhs].name < stops[rhs].name; });
+
+    // Создаём проектор сферических координат на карту (по всем остановкам справочника, кроме удалённых)
+    vector<Stop> projected_stops;
+    projected_stops.reserve(stops.size());
+
+    for (StopId stop_id = 0; stop_id < stops.size(); ++stop_id) {
+        if (!catalogue_.IsStopRemoved(stop_id)) projected_stops.push_back(stops[stop_id]);
+    }
+
+    const SphereProjector projector(projected_stops.begin(), projected_stops.end(), settings.width, settings.height, settings.padding);
+
+    // Проецируем на карту остановки, через которые проходят маршруты
+    model.stop_points.resize(stops.size());
+    for (const StopId stop_id : model.stops) {
+        model.stop_points[stop_id] = projector(stops[stop_id].coordinate);
+    }
+
+    render_model_ = move(model);
+    return *render_model_;
+}
+
+// Функция отрисовки карты маршрутов в строку с SVG-документом
+string MapRenderer::RenderMapDocument(const RenderSettings& settings) const {
+    using namespace detail;
+
+    // Модель отрисовки: отсортированные маршруты и остановки и их точки на карте
+    const RenderModel& model = GetRenderModel(settings);
+
+    // SVG-документ с картой маршрутов (объекты хранятся по значению)
+    FlatDocument result;
+    result.Reserve(3 * model.buses.size() + 3 * model.stops.size());
 
     // Отрисовываем линии маршрутов на карте маршрутов
-    RenderRoutesPaths(result, projector, settings);
+    RenderRoutesPaths(result, model, settings);
 
     // Отрисовываем названия маршрутов на карте маршрутов
-    RenderRoutesNames(result, projector, settings);
+    RenderRoutesNames(result, model, settings);
 
     // Отрисовываем точки остановок на карте маршрутов
-    RenderRoutesStopsPoints(result, projector, settings);
+    RenderRoutesStopsPoints(result, model, settings);
 
     // Отрисовываем названия остановок на карте маршрутов
-    RenderRoutesStopsNames(result, projector, settings);
+    RenderRoutesStopsNames(result, model, settings);
+
+    // Отрисовываем SVG-документ с картой маршрутов в один непрерывный буфер
+    Buffer buffer;
+    result.Render(buffer);
 
-    // Отрисовываем SVG-документ с картой маршрутов
-    result.Render(output);
+    return buffer.Release();
 }
 
 }
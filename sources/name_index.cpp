@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include "name_index.h"
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue
+namespace detail {
+
+// Число попыток построения с разными затравками, после которых индекс остаётся хеш-таблицей
+constexpr int MAX_BUILD_ATTEMPTS = 4;
+
+// Функция перемешивания битов хеша (финализатор splitmix64)
+uint64_t Mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    value ^= value >> 31;
+    return value;
+}
+
+// Функция получения хеша названия (затравка меняет распределение по корзинам при повторной попытке построения)
+uint64_t Hash(string_view name, uint64_t seed) {
+    return Mix(hash<string_view>{}(name) + seed * 0x9E3779B97F4A7C15ull);
+}
+
+// Функция отображения 32-битного значения на отрезок [0, count) умножением (без деления)
+size_t Reduce(uint32_t value, size_t count) {
+    return static_cast<size_t>((uint64_t{ value } * count) >> 32);
+}
+
+// Функция получения корзины названия по младшим битам хеша. Распределение неравномерное: 60% названий попадают
+// в первые 30% корзин. Большие корзины размещаются, пока таблица почти пуста, а к концу остаются в основном
+// корзины из одного названия, для которых свободную ячейку найти проще всего
+size_t GetBucket(uint64_t hash, size_t buckets_count) {
+    const uint32_t low = static_cast<uint32_t>(hash);
+    const size_t dense_count = buckets_count * 3 / 10;
+
+    // Первые 60% отрезка [0, buckets_count / 2) - это как раз первые 30% корзин
+    const size_t bucket = Reduce(low, buckets_count / 2);
+    if (bucket < dense_count) return bucket;
+
+    // Остальные названия равномерно распределяются по прочим корзинам (младшие биты перемешиваются умножением)
+    return dense_count + Reduce(low * 0x9E3779B1u, buckets_count - dense_count);
+}
+
+// Функция получения ячейки названия по старшим битам хеша (не зависят от корзины) при смещении корзины pilot
+size_t GetSlot(uint64_t hash, uint32_t pilot, size_t slots_count) {
+    return Reduce(static_cast<uint32_t>((hash ^ (pilot * 0x9E3779B97F4A7C15ull)) >> 32), slots_count);
+}
+
+}
+
+// Функция задания идентификатора для названия (повторное задание перезаписывает идентификатор)
+void NameIndex::Set(string_view name, uint32_t id) {
+    if (!slots_.empty()) {
+        Slot& slot = slots_[GetPosition(name)];
+
+        // Название из таблицы (в том числе удалённое) меняется на месте и никогда не попадает в added_
+        if (string_view(slot.data, slot.length) == name) {
+            if (slot.id == NO_ID) --removed_count_;
+            slot.id = id;
+            return;
+        }
+    }
+
+    added_[name] = id;
+
+    CompactIfNeeded();
+}
+
+// Функция удаления названия. Возвращает false, если названия нет в индексе
+bool NameIndex::Erase(string_view name) {
+    if (!slots_.empty()) {
+        Slot& slot = slots_[GetPosition(name)];
+
+        if (string_view(slot.data, slot.length) == name) {
+            if (slot.id == NO_ID) return false;
+
+            slot.id = NO_ID;
+            ++removed_count_;
+
+            CompactIfNeeded();
+            return true;
+        }
+    }
+
+    return added_.erase(name) > 0;
+}
+
+// Функция поиска идентификатора по названию
+optional<uint32_t> NameIndex::Find(string_view name) const {
+    if (!slots_.empty()) {
+        const Slot& slot = slots_[GetPosition(name)];
+
+        if (string_view(slot.data, slot.length) == name) {
+            if (slot.id == NO_ID) return nullopt;
+            return slot.id;
+        }
+    }
+
+    // В замороженной базе обычно пусто, и промах обходится без второго хеширования
+    if (added_.empty()) return nullopt;
+
+    const auto it = added_.find(name);
+    if (it == added_.end()) return nullopt;
+    return it->second;
+}
+
+// Функция построения совершенной хеш-функции по всем названиям индекса
+// (если подобрать её не удалось, индекс остаётся хеш-таблицей).
+// До построения индекс - обычная хеш-таблица. При построении строится минимальная совершенная хеш-функция
+// (hash-and-displace): название попадает в корзину, а подобранное для корзины смещение определяет ячейку таблицы,
+// причём у разных названий ячейки разные и таблица заполнена целиком. Поиск - одно обращение к таблице смещений
+// (в среднем по три названия на корзину) и одно к ячейке, где для отсечения промахов лежит само название.
+// Изменения после построения не требуют перестроения: идентификатор существующего названия меняется в ячейке на месте,
+// удалённое название помечается, а новые попадают в небольшую хеш-таблицу, пока её не выгодно слить с основной
+void NameIndex::Build() {
+    using namespace detail;
+
+    vector<Slot> entries;
+    entries.reserve(slots_.size() - removed_count_ + added_.size());
+
+    for (const Slot& slot : slots_) {
+        if (slot.id != NO_ID) entries.push_back(slot);
+    }
+
+    for (const auto& [name, id] : added_) {
+        entries.push_back({ name.data(), static_cast<uint32_t>(name.size()), id });
+    }
+
+    removed_count_ = 0;
+
+    vector<uint64_t> hashes(entries.size());
+
+    for (int attempt = 0; attempt < MAX_BUILD_ATTEMPTS; ++attempt, ++seed_) {
+        for (size_t n = 0; n < entries.size(); ++n) {
+            hashes[n] = Hash(string_view(entries[n].data, entries[n].length), seed_);
+        }
+
+        // Названия с совпадающими хешами не разделит никакое смещение и никакая затравка
+        if (attempt == 0) {
+            vector<uint64_t> sorted_hashes = hashes;
+            sort(sorted_hashes.begin(), sorted_hashes.end());
+            if (adjacent_find(sorted_hashes.begin(), sorted_hashes.end()) != sorted_hashes.end()) break;
+        }
+
+        if (BuildTable(entries, hashes)) {
+            added_.clear();
+            return;
+        }
+    }
+
+    // Подобрать не удалось: все названия остаются в хеш-таблице
+    pilots_.clear();
+    slots_.clear();
+    added_.clear();
+
+    for (const Slot& entry : entries) {
+        added_[string_view(entry.data, entry.length)] = entry.id;
+    }
+}
+
+// Функция получения номера ячейки таблицы для названия (название может в ней и не лежать)
+size_t NameIndex::GetPosition(string_view name) const {
+    using namespace detail;
+
+    const uint64_t hash = Hash(name, seed_);
+    return GetSlot(hash, pilots_[GetBucket(hash, pilots_.size())], slots_.size());
+}
+
+// Функция подбора смещений для названий (false, если подобрать не удалось)
+bool NameIndex::BuildTable(const vector<Slot>& entries, const vector<uint64_t>& hashes) {
+    using namespace detail;
+
+    const size_t count = entries.size();
+    const size_t buckets_count = count / BUCKET_SIZE + 1;
+
+    // Названия, сгруппированные по корзинам (сортировка подсчётом)
+    vector<uint32_t> bucket_begin(buckets_count + 1, 0);
+    vector<uint32_t> entry_bucket(count);
+
+    for (size_t n = 0; n < count; ++n) {
+        entry_bucket[n] = static_cast<uint32_t>(GetBucket(hashes[n], buckets_count));
+        ++bucket_begin[entry_bucket[n] + 1];
+    }
+
+    partial_sum(bucket_begin.begin(), bucket_begin.end(), bucket_begin.begin());
+
+    vector<uint32_t> bucket_entries(count);
+    vector<uint32_t> cursor(bucket_begin.begin(), bucket_begin.end() - 1);
+
+    for (size_t n = 0; n < count; ++n) {
+        bucket_entries[cursor[entry_bucket[n]]++] = static_cast<uint32_t>(n);
+    }
+
+    // Большие корзины размещаются первыми, пока свободных ячеек много
+    vector<uint32_t> buckets_order(buckets_count);
+    iota(buckets_order.begin(), buckets_order.end(), 0u);
+
+    stable_sort(buckets_order.begin(), buckets_order.end(), [&bucket_begin](uint32_t lhs, uint32_t rhs) {
+        return bucket_begin[lhs + 1] - bucket_begin[lhs] > bucket_begin[rhs + 1] - bucket_begin[rhs];
+    });
+
+    // Последним корзинам из одного названия достаётся одна из немногих свободных ячеек: в среднем для этого
+    // нужно перебрать столько смещений, сколько ячеек приходится на свободную
+    const uint64_t max_pilot = min<uint64_t>(UINT32_MAX - 1u, 64u * count + 1024u);
+
+    vector<uint32_t> pilots(buckets_count, 0);
+    vector<Slot>     slots(count);
+    vector<uint8_t>  is_taken(count, 0);
+    vector<size_t>   positions;
+
+    for (uint32_t bucket : buckets_order) {
+        const uint32_t begin = bucket_begin[bucket];
+        const uint32_t end   = bucket_begin[bucket + 1];
+        if (begin == end) break;
+
+        for (uint32_t pilot = 0; ; ++pilot) {
+            if (pilot > max_pilot) return false;
+
+            positions.clear();
+
+            for (uint32_t n = begin; n < end; ++n) {
+                const size_t position = GetSlot(hashes[bucket_entries[n]], pilot, count);
+                if (is_taken[position] || find(positions.begin(), positions.end(), position) != positions.end()) break;
+                positions.push_back(position);
+            }
+
+            if (positions.size() != end - begin) continue;
+
+            for (uint32_t n = begin; n < end; ++n) {
+                is_taken[positions[n - begin]] = 1;
+                slots[positions[n - begin]] = entries[bucket_entries[n]];
+            }
+
+            pilots[bucket] = pilot;
+            break;
+        }
+    }
+
+    pilots_ = move(pilots);
+    slots_  = move(slots);
+
+    return true;
+}
+
+// Функция перестроения, если изменений накопилось слишком много
+void NameIndex::CompactIfNeeded() {
+    // Пока индекс не построен, все названия и так лежат в хеш-таблице
+    if (slots_.empty()) return;
+
+    const size_t changes = added_.size() + removed_count_;
+    if (changes <= max<size_t>(1024u, slots_.size() / 8u)) return;
+
+    Build();
+}
+
+}
\ No newline at end of file
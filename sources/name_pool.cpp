@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <limits>
+#include "name_pool.h"
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Функция добавления названия в пул (возвращает стабильное представление добавленной копии)
+string_view NamePool::Add(string_view name) {
+    // Описатели хранят 32-битные смещения
+    if (GetSize() + name.size() > numeric_limits<uint32_t>::max()) {
+        throw length_error("Name pool is too large"s);
+    }
+
+    if (blocks_.empty() || blocks_.back().capacity - blocks_.back().size < name.size()) {
+        AddBlock(name.size());
+    }
+
+    Block& block = blocks_.back();
+    char* destination = block.data.get() + block.size;
+
+    if (!name.empty()) memcpy(destination, name.data(), name.size());
+    block.size += name.size();
+
+    return string_view(destination, name.size());
+}
+
+// Функция резервирования места под size байт названий в текущем блоке
+// (если известен суммарный размер названий, все они окажутся в одном непрерывном блоке)
+void NamePool::Reserve(size_t size) {
+    if (blocks_.empty() || blocks_.back().capacity - blocks_.back().size < size) {
+        AddBlock(size);
+    }
+}
+
+// Функция получения описателя для названия, которое вернула функция Add
+NameHandle NamePool::GetHandle(string_view stored_name) const {
+    // Блоков немного (их размеры растут вдвое), а самый свежий блок обычно самый большой
+    for (auto it = blocks_.rbegin(); it != blocks_.rend(); ++it) {
+        const char* begin = it->data.get();
+
+        if (less_equal<const char*>{}(begin, stored_name.data()) && less_equal<const char*>{}(stored_name.data() + stored_name.size(), begin + it->size)) {
+            return NameHandle{ static_cast<uint32_t>(it->offset + (stored_name.data() - begin)), static_cast<uint32_t>(stored_name.size()) };
+        }
+    }
+
+    throw invalid_argument("Name \""s + string(stored_name) + "\" is not stored in the pool"s);
+}
+
+// Функция получения суммарного размера названий в пуле
+size_t NamePool::GetSize() const {
+    return blocks_.empty() ? 0 : blocks_.back().offset + blocks_.back().size;
+}
+
+// Функция дописывания содержимого пула в строку out (смещения описателей отсчитываются от начала дописанного)
+void NamePool::AppendTo(string& out) const {
+    out.reserve(out.size() + GetSize());
+
+    for (const Block& block : blocks_) {
+        out.append(block.data.get(), block.size);
+    }
+}
+
+// Функция добавления блока, в который поместится не меньше size байт
+void NamePool::AddBlock(size_t size) {
+    const size_t capacity = max({ size, MIN_BLOCK_SIZE, blocks_.empty() ? size_t{ 0 } : 2 * blocks_.back().capacity });
+
+    Block block;
+    block.data     = unique_ptr<char[]>(new char[capacity]);
+    block.capacity = capacity;
+    block.offset   = GetSize();
+
+    blocks_.push_back(move(block));
+}
+
+}
\ No newline at end of file
@@ -1,4 +1,9 @@
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <optional>
 #include "request_handler.h"
+#include "instrumentation.h"
 using namespace std;
 
 // Пространство имён транспортного справочника
@@ -7,6 +12,34 @@ namespace transport_catalogue {
 // Пространство имён для функционала, связанного с запросами к транспортному справочнику
 namespace request_handler {
 
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue::request_handler
+namespace detail {
+
+// Класс, вызывающий функцию при выходе из области видимости (в том числе по исключению)
+template <typename Function>
+class ScopeGuard {
+public:
+	explicit ScopeGuard(Function function) : function_(move(function)) { }
+	~ScopeGuard() { function_(); }
+
+	ScopeGuard(const ScopeGuard&) = delete;
+	ScopeGuard& operator = (const ScopeGuard&) = delete;
+
+private:
+	Function function_;
+};
+
+// Функция получения явно заданного расстояния между остановками по их названиям (nullopt, если остановки или расстояния нет)
+optional<int> GetExplicitDistance(const TransportCatalogue& catalogue, string_view from, string_view to) {
+	const auto from_id = catalogue.FindStopId(from);
+	const auto to_id   = catalogue.FindStopId(to);
+	if (!from_id || !to_id) return nullopt;
+
+	return catalogue.GetExplicitDistance(*from_id, *to_id);
+}
+
+}
+
 RequestHandler::RequestHandler(TransportCatalogue& catalogue,
                                map_renderer::MapRenderer& renderer) : catalogue_(catalogue),
 							                                          renderer_(renderer) { }
@@ -14,6 +47,7 @@ RequestHandler::RequestHandler(TransportCatalogue& catalogue,
 // Функция задания данных транспортного справочника
 void RequestHandler::SetData(const vector<AddStopRequest>& add_stop_requests,
                              const vector<AddBusRequest>&  add_bus_requests) {
+	TRANSPORT_CATALOGUE_SCOPED_PHASE(SetData);
 
     // Добавляем в базу остановки
 	for (const AddStopRequest& add_stop_request : add_stop_requests) {
@@ -31,6 +65,226 @@ void RequestHandler::SetData(const vector<AddStopRequest>& add_stop_requests,
 	for (const AddBusRequest& add_bus_request : add_bus_requests) {
 		catalogue_.AddBus(add_bus_request.name, add_bus_request.type, add_bus_request.stops);
 	}
+
+	// Замораживаем базу: статистика маршрутов считается один раз, а не на каждый запрос
+	CompleteData();
+}
+
+// Функция добавления остановки вместе с расстояниями до соседних остановок (для потоковой загрузки базы)
+void RequestHandler::AddStop(const AddStopRequest& add_stop_request) {
+	catalogue_.AddStop(add_stop_request.name, add_stop_request.coordinate);
+
+	for (const auto& [stop_to, distance] : add_stop_request.distances) {
+		catalogue_.SetDistance(add_stop_request.name, stop_to, distance);
+	}
+}
+
+// Функция добавления маршрута (для потоковой загрузки базы)
+void RequestHandler::AddBus(const AddBusRequest& add_bus_request) {
+	catalogue_.AddBus(add_bus_request.name, add_bus_request.type, add_bus_request.stops);
+}
+
+// Функция задания настроек маршрутизации (граф маршрутов строится при завершении заполнения базы)
+void RequestHandler::SetRoutingSettings(const transport_router::RoutingSettings& settings) {
+	routing_settings_ = settings;
+	router_.reset();
+}
+
+// Функция завершения заполнения базы данных (после неё база замораживается и строится граф маршрутов)
+void RequestHandler::CompleteData() {
+	{
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(Freeze);
+		catalogue_.Freeze();
+	}
+
+	{
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(SpatialIndexBuild);
+		spatial_index_ = make_unique<spatial_index::SpatialIndex>(catalogue_);
+	}
+
+	if (routing_settings_) {
+		TRANSPORT_CATALOGUE_SCOPED_PHASE(RouterBuild);
+		router_ = make_unique<transport_router::TransportRouter>(catalogue_, *routing_settings_);
+	}
+}
+
+// Функция изменения замороженной базы данных пакетом изменений. Пакет применяется целиком или не применяется вовсе:
+// для каждого применённого изменения запоминается обратное, и при ошибке они применяются в обратном порядке.
+// Справочник обновляется по частям, а в пространственном индексе и графе маршрутов пересчитываются только затронутые
+// остановки и рёбра из них (и при успехе, и при откате)
+void RequestHandler::UpdateData(const UpdateRequests& update_requests) {
+	TRANSPORT_CATALOGUE_SCOPED_PHASE(UpdateData);
+
+	vector<StopId> moved_stops; // Остановки, у которых изменились координаты, а также добавленные и удалённые
+	vector<StopId> route_stops; // Остановки, рёбра из которых в графе маршрутов нужно пересчитать
+
+	// После отката идентификаторы восстановленных маршрутов и остановок могут отличаться от прежних,
+	// поэтому производные структуры обновляются при любом выходе из функции (по всем затронутым остановкам сразу)
+	detail::ScopeGuard refresh_derived([this, &moved_stops, &route_stops] {
+		if (!moved_stops.empty()) {
+			TRANSPORT_CATALOGUE_SCOPED_PHASE(SpatialIndexBuild);
+			spatial_index_->Update(moved_stops);
+		}
+
+		if (routing_settings_ && !route_stops.empty()) {
+			TRANSPORT_CATALOGUE_SCOPED_PHASE(RouterBuild);
+			if (router_) router_->Update(move(route_stops));
+			else         router_ = make_unique<transport_router::TransportRouter>(catalogue_, *routing_settings_);
+		}
+	});
+
+	// Функция отметки всех остановок маршрута как затронутых
+	auto touch_bus = [this, &route_stops](string_view name) {
+		if (const auto id = catalogue_.FindBusId(name)) {
+			const vector<StopId>& stops = catalogue_.GetBus(*id).stops;
+			route_stops.insert(route_stops.end(), stops.begin(), stops.end());
+		}
+	};
+
+	// Функция отметки остановок всех маршрутов, проходящих через остановку: расстояние или координаты остановки
+	// влияют на время поездки по этим маршрутам из любой их остановки
+	auto touch_stop = [this, &route_stops, &touch_bus](string_view name) {
+		const auto id = catalogue_.FindStopId(name);
+		if (!id) return;
+
+		route_stops.push_back(*id);
+
+		if (const auto stop_info = catalogue_.GetStopInfo(name)) {
+			for (string_view bus : stop_info->buses) touch_bus(bus);
+		}
+	};
+
+	// Изменения, обратные применённым (названия берутся из запросов или из справочника и остаются действительными)
+	vector<function<void()>> undo;
+
+	// Функция изменения расстояния с запоминанием обратного изменения
+	auto update_distance = [this, &undo, &touch_stop](string_view from, string_view to, int distance) {
+		const optional<int> previous = detail::GetExplicitDistance(catalogue_, from, to);
+
+		catalogue_.UpdateDistance(from, to, distance);
+		touch_stop(from);
+
+		undo.push_back([this, from, to, previous] {
+			if (previous) catalogue_.UpdateDistance(from, to, *previous);
+			else          catalogue_.RemoveDistance(from, to);
+		});
+	};
+
+	// Функция получения обратного изменения для маршрута (восстановление прежних остановок или удаление нового маршрута)
+	auto restore_bus = [this](string_view name) -> function<void()> {
+		const auto id = catalogue_.FindBusId(name);
+		if (!id) return [this, name] { catalogue_.RemoveBus(name); };
+
+		const Bus& bus = catalogue_.GetBus(*id);
+
+		vector<string_view> stops;
+		stops.reserve(bus.stops.size());
+		for (StopId stop_id : bus.stops) {
+			stops.push_back(catalogue_.GetStop(stop_id).name);
+		}
+
+		return [this, name = bus.name, type = bus.type, stops = move(stops)] { catalogue_.UpdateBus(name, type, stops); };
+	};
+
+	try {
+		// Сначала добавляем остановки, а затем расстояния, чтобы расстояния могли ссылаться на новые остановки
+		for (const AddStopRequest& update_stop_request : update_requests.update_stops) {
+			const string_view name = update_stop_request.name;
+			const auto id = catalogue_.FindStopId(name);
+
+			function<void()> restore_stop;
+			if (id) restore_stop = [this, name, coordinate = catalogue_.GetStop(*id).coordinate] { catalogue_.UpdateStop(name, coordinate); };
+			else    restore_stop = [this, name] { catalogue_.RemoveStop(name); };
+
+			catalogue_.UpdateStop(name, update_stop_request.coordinate);
+			undo.push_back(move(restore_stop));
+
+			moved_stops.push_back(*catalogue_.FindStopId(name));
+			touch_stop(name);
+		}
+
+		for (const AddStopRequest& update_stop_request : update_requests.update_stops) {
+			for (const auto& [stop_to, distance] : update_stop_request.distances) {
+				update_distance(update_stop_request.name, stop_to, distance);
+			}
+		}
+
+		for (const SetDistanceRequest& update_distance_request : update_requests.update_distances) {
+			update_distance(update_distance_request.from, update_distance_request.to, update_distance_request.distance);
+		}
+
+		for (string_view bus : update_requests.remove_buses) {
+			function<void()> restore = restore_bus(bus);
+			touch_bus(bus);
+
+			if (catalogue_.RemoveBus(bus)) {
+				undo.push_back(move(restore));
+			}
+		}
+
+		for (const AddBusRequest& update_bus_request : update_requests.update_buses) {
+			function<void()> restore = restore_bus(update_bus_request.name);
+			touch_bus(update_bus_request.name);
+
+			catalogue_.UpdateBus(update_bus_request.name, update_bus_request.type, update_bus_request.stops);
+			undo.push_back(move(restore));
+			touch_bus(update_bus_request.name);
+		}
+
+		for (const auto& [stop_from, stop_to] : update_requests.remove_distances) {
+			const optional<int> previous = detail::GetExplicitDistance(catalogue_, stop_from, stop_to);
+
+			if (catalogue_.RemoveDistance(stop_from, stop_to)) {
+				touch_stop(stop_from);
+				undo.push_back([this, from = stop_from, to = stop_to, distance = *previous] { catalogue_.UpdateDistance(from, to, distance); });
+			}
+		}
+
+		// Удаление остановки отклоняется, только если через неё проходят маршруты, а маршруты к этому моменту уже изменены.
+		// Поэтому все остановки проверяются до удаления первой из них, и откатывать удаление остановок не приходится
+		for (string_view stop : update_requests.remove_stops) {
+			if (const auto id = catalogue_.FindStopId(stop); id && catalogue_.IfBusesOnStop(*id)) {
+				throw invalid_argument("Stop \""s + string(stop) + "\" cannot be removed: buses pass through it"s);
+			}
+		}
+
+		for (string_view stop : update_requests.remove_stops) {
+			const auto id = catalogue_.FindStopId(stop);
+
+			if (catalogue_.RemoveStop(stop)) {
+				moved_stops.push_back(*id);
+				route_stops.push_back(*id);
+			}
+		}
+	}
+	catch (...) {
+		for (auto it = undo.rbegin(); it != undo.rend(); ++it) {
+			(*it)();
+		}
+		throw;
+	}
+}
+
+// Функция сохранения замороженной базы данных и настроек в бинарный файл (и в образ базы данных, если он задан)
+void RequestHandler::SaveBase(const serialization::SerializationSettings& serialization_settings, const serialization::BaseSettings& base_settings) const {
+	serialization::SaveBaseToFile(serialization_settings.file, catalogue_, base_settings);
+
+	if (!serialization_settings.image_file.empty()) {
+		catalogue_image::SaveImageToFile(serialization_settings.image_file, catalogue_);
+	}
+}
+
+// Функция загрузки базы данных из бинарного файла в пустой справочник (после неё база заморожена и граф маршрутов построен)
+serialization::BaseSettings RequestHandler::LoadBase(const serialization::SerializationSettings& serialization_settings) {
+	serialization::BaseSettings base_settings = serialization::LoadBaseFromFile(serialization_settings.file, catalogue_);
+
+	if (base_settings.routing_settings) {
+		SetRoutingSettings(*base_settings.routing_settings);
+	}
+
+	CompleteData();
+
+	return base_settings;
 }
 
 // Функция получения информации об остановке
@@ -48,6 +302,34 @@ void RequestHandler::RenderMap(const map_renderer::RenderSettings& settings, ost
 	renderer_.RenderMap(settings, output);
 }
 
+// Функция построения маршрута поездки между остановками (память route переиспользуется между вызовами).
+// Возвращает false, если одной из остановок нет в базе, маршрута между ними не существует или не заданы настройки маршрутизации
+bool RequestHandler::BuildRoute(string_view from, string_view to, RouteInfo& route) const {
+	// Без настроек маршрутизации граф не строится: запрос получает ответ "не найдено", а не прерывает обработку пакета
+	if (!router_) {
+		route.total_time = 0.0;
+		route.items.clear();
+		return false;
+	}
+
+	const auto from_id = catalogue_.FindStopId(from);
+	const auto to_id   = catalogue_.FindStopId(to);
+
+	if (!from_id || !to_id) return false;
+
+	return router_->BuildRoute(*from_id, *to_id, route);
+}
+
+// Функция поиска остановок на расстоянии не более radius метров от точки center
+// (результат упорядочен по расстоянию, память result переиспользуется между вызовами)
+void RequestHandler::FindStopsNearby(const geo::Coordinate& center, double radius, vector<NearbyStop>& result) const {
+	if (!spatial_index_) {
+		throw logic_error("Database is not completed"s);
+	}
+
+	spatial_index_->FindStopsNearby(center, radius, result);
+}
+
 }
 
 }
\ No newline at end of file
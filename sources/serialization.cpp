@@ -0,0 +1,420 @@
+#include <fstream>
+#include <cstring>
+#include <type_traits>
+#include "serialization.h"
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с сохранением базы данных справочника в бинарный файл
+namespace serialization {
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue::serialization
+namespace detail {
+
+// Сигнатура бинарного файла базы данных
+constexpr string_view SIGNATURE = "TCDB"sv;
+
+// Класс записи значений в бинарный буфер (числа записываются в порядке байтов текущей платформы)
+class Writer {
+public:
+    template <typename Value>
+    void Write(Value value) {
+        static_assert(is_trivially_copyable_v<Value>);
+        data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void WriteString(string_view str) {
+        Write(static_cast<uint32_t>(str.size()));
+        data_.append(str);
+    }
+
+    void WriteRaw(string_view data) {
+        data_.append(data);
+    }
+
+    void WriteNamePool(const NamePool& names) {
+        Write(static_cast<uint32_t>(names.GetSize()));
+        names.AppendTo(data_);
+    }
+
+    const string& GetData() const {
+        return data_;
+    }
+
+private:
+    string data_;
+};
+
+// Класс чтения значений из бинарного буфера (при выходе за конец буфера бросается исключение)
+class Reader {
+public:
+    explicit Reader(string_view data) : data_(data) { }
+
+    template <typename Value>
+    Value Read() {
+        static_assert(is_trivially_copyable_v<Value>);
+        Value value;
+        memcpy(&value, Take(sizeof(value)).data(), sizeof(value));
+        return value;
+    }
+
+    string_view ReadString() {
+        return Take(Read<uint32_t>());
+    }
+
+    string_view Take(size_t size) {
+        if (size > data_.size() - pos_) throw SerializationError("Unexpected end of the base file"s);
+        string_view result = data_.substr(pos_, size);
+        pos_ += size;
+        return result;
+    }
+
+    bool IsEnd() const {
+        return pos_ == data_.size();
+    }
+
+private:
+    string_view data_;
+    size_t pos_ = 0;
+};
+
+// Индексы вариантов цвета в бинарном файле
+enum class ColorType : uint8_t { None, String, Rgb, Rgba };
+
+// Функция записи точки
+void WritePoint(Writer& writer, const svg::Point& point) {
+    writer.Write(point.x);
+    writer.Write(point.y);
+}
+
+// Функция чтения точки
+svg::Point ReadPoint(Reader& reader) {
+    svg::Point point;
+    point.x = reader.Read<double>();
+    point.y = reader.Read<double>();
+    return point;
+}
+
+// Объект для записи цвета, представленного в различных форматах (не задан/строка/RGB/RGBa)
+struct ColorWriter {
+    Writer& writer;
+
+    void operator() (monostate) const {
+        writer.Write(ColorType::None);
+    }
+
+    void operator() (const string& str) const {
+        writer.Write(ColorType::String);
+        writer.WriteString(str);
+    }
+
+    void operator() (const svg::Rgb& rgb) const {
+        writer.Write(ColorType::Rgb);
+        writer.Write(rgb.red);
+        writer.Write(rgb.green);
+        writer.Write(rgb.blue);
+    }
+
+    void operator() (const svg::Rgba& rgba) const {
+        writer.Write(ColorType::Rgba);
+        writer.Write(rgba.red);
+        writer.Write(rgba.green);
+        writer.Write(rgba.blue);
+        writer.Write(rgba.opacity);
+    }
+};
+
+// Функция чтения цвета
+svg::Color ReadColor(Reader& reader) {
+    switch (reader.Read<ColorType>()) {
+        case ColorType::None:
+            return svg::NoneColor;
+
+        case ColorType::String:
+            return string(reader.ReadString());
+
+        case ColorType::Rgb: {
+            svg::Rgb rgb;
+            rgb.red   = reader.Read<uint8_t>();
+            rgb.green = reader.Read<uint8_t>();
+            rgb.blue  = reader.Read<uint8_t>();
+            return rgb;
+        }
+
+        case ColorType::Rgba: {
+            svg::Rgba rgba;
+            rgba.red     = reader.Read<uint8_t>();
+            rgba.green   = reader.Read<uint8_t>();
+            rgba.blue    = reader.Read<uint8_t>();
+            rgba.opacity = reader.Read<double>();
+            return rgba;
+        }
+    }
+
+    throw SerializationError("Unknown color type in the base file"s);
+}
+
+// Функция записи настроек отрисовки карты
+void WriteRenderSettings(Writer& writer, const map_renderer::RenderSettings& settings) {
+    writer.Write(settings.width);
+    writer.Write(settings.height);
+    writer.Write(settings.padding);
+    writer.Write(settings.line_width);
+    writer.Write(settings.stop_radius);
+
+    writer.Write(settings.bus_label_font_size);
+    WritePoint(writer, settings.bus_label_offset);
+
+    writer.Write(settings.stop_label_font_size);
+    WritePoint(writer, settings.stop_label_offset);
+
+    visit(ColorWriter{ writer }, settings.underlayer_color);
+    writer.Write(settings.underlayer_width);
+
+    writer.Write(static_cast<uint32_t>(settings.color_palette.size()));
+    for (const svg::Color& color : settings.color_palette) {
+        visit(ColorWriter{ writer }, color);
+    }
+}
+
+// Функция чтения настроек отрисовки карты
+map_renderer::RenderSettings ReadRenderSettings(Reader& reader) {
+    map_renderer::RenderSettings settings;
+
+    settings.width       = reader.Read<double>();
+    settings.height      = reader.Read<double>();
+    settings.padding     = reader.Read<double>();
+    settings.line_width  = reader.Read<double>();
+    settings.stop_radius = reader.Read<double>();
+
+    settings.bus_label_font_size = reader.Read<uint32_t>();
+    settings.bus_label_offset    = ReadPoint(reader);
+
+    settings.stop_label_font_size = reader.Read<uint32_t>();
+    settings.stop_label_offset    = ReadPoint(reader);
+
+    settings.underlayer_color = ReadColor(reader);
+    settings.underlayer_width = reader.Read<double>();
+
+    const uint32_t palette_size = reader.Read<uint32_t>();
+    for (uint32_t i = 0; i < palette_size; ++i) {
+        settings.color_palette.push_back(ReadColor(reader));
+    }
+
+    return settings;
+}
+
+}
+
+// Функция сохранения замороженной базы данных и настроек в бинарный поток.
+// Формат: сигнатура, версия формата, затем пул названий, остановки, маршруты, расстояния и настройки подряд
+void SaveBase(ostream& output, const TransportCatalogue& catalogue, const BaseSettings& settings) {
+    using namespace detail;
+
+    Writer writer;
+
+    writer.WriteRaw(SIGNATURE);
+    writer.Write(FORMAT_VERSION);
+
+    // Пул названий сохраняется одним куском, а остановки и маршруты ссылаются на свои названия описателями
+    const NamePool& names = catalogue.GetNamePool();
+    writer.WriteNamePool(names);
+
+    // Остановки в порядке идентификаторов, поэтому при загрузке идентификаторы сохраняются
+    // (удалённые остановки пропускаются, а идентификаторы следующих за ними сдвигаются)
+    const auto& stops = catalogue.GetStops();
+
+    vector<StopId> saved_ids(stops.size());
+    uint32_t saved_stops_count = 0;
+
+    for (StopId id = 0; id < stops.size(); ++id) {
+        if (!catalogue.IsStopRemoved(id)) saved_ids[id] = saved_stops_count++;
+    }
+
+    writer.Write(saved_stops_count);
+
+    for (StopId id = 0; id < stops.size(); ++id) {
+        if (catalogue.IsStopRemoved(id)) continue;
+
+        writer.Write(names.GetHandle(stops[id].name));
+        writer.Write(stops[id].coordinate.lat);
+        writer.Write(stops[id].coordinate.lng);
+    }
+
+    // Маршруты в порядке добавления (включая повторно добавленные с тем же названием, но без удалённых)
+    const auto& buses = catalogue.GetBuses();
+
+    vector<BusId> saved_buses;
+    for (BusId id = 0; id < buses.size(); ++id) {
+        if (catalogue.FindBusId(buses[id].name)) saved_buses.push_back(id);
+    }
+
+    writer.Write(static_cast<uint32_t>(saved_buses.size()));
+
+    for (BusId id : saved_buses) {
+        const Bus& bus = buses[id];
+
+        writer.Write(names.GetHandle(bus.name));
+        writer.Write(static_cast<uint8_t>(bus.type == BusRouteType::Circle));
+        writer.Write(static_cast<uint32_t>(bus.stops.size()));
+        for (StopId stop : bus.stops) {
+            writer.Write(saved_ids[stop]);
+        }
+    }
+
+    // Явно заданные расстояния (обратные достраиваются при заморозке)
+    const auto distances = catalogue.GetRoadDistances();
+    writer.Write(static_cast<uint32_t>(distances.size()));
+
+    for (const RoadDistance& distance : distances) {
+        writer.Write(saved_ids[distance.from]);
+        writer.Write(saved_ids[distance.to]);
+        writer.Write(static_cast<int32_t>(distance.distance));
+    }
+
+    // Настройки
+    writer.Write(static_cast<uint8_t>(settings.render_settings.has_value()));
+    if (settings.render_settings) {
+        WriteRenderSettings(writer, *settings.render_settings);
+    }
+
+    writer.Write(static_cast<uint8_t>(settings.routing_settings.has_value()));
+    if (settings.routing_settings) {
+        writer.Write(static_cast<int32_t>(settings.routing_settings->bus_wait_time));
+        writer.Write(settings.routing_settings->bus_velocity);
+    }
+
+    const string& data = writer.GetData();
+    output.write(data.data(), static_cast<streamsize>(data.size()));
+}
+
+// Функция загрузки базы данных из бинарного буфера в пустой справочник (возвращает сохранённые настройки,
+// для непустого справочника - std::invalid_argument). После загрузки справочник нужно заморозить, как и после заполнения из JSON
+BaseSettings LoadBase(string_view input, TransportCatalogue& catalogue) {
+    using namespace detail;
+
+    // Загрузка в непустой справочник смешала бы две базы
+    if (!catalogue.GetStops().empty() || !catalogue.GetBuses().empty()) {
+        throw invalid_argument("Base can be loaded only into an empty catalogue"s);
+    }
+
+    Reader reader(input);
+
+    if (input.substr(0, SIGNATURE.size()) != SIGNATURE) {
+        throw SerializationError("Invalid base file signature"s);
+    }
+    reader.Take(SIGNATURE.size());
+
+    if (const uint32_t version = reader.Read<uint32_t>(); version != FORMAT_VERSION) {
+        throw SerializationError("Unsupported base file format version "s + to_string(version));
+    }
+
+    // Пул названий: все названия справочника поместятся в один блок его собственного пула
+    const string_view names = reader.ReadString();
+    catalogue.ReserveNames(names.size());
+
+    auto read_name = [&reader, names] {
+        const NameHandle handle = reader.Read<NameHandle>();
+        if (handle.offset > names.size() || handle.length > names.size() - handle.offset) {
+            throw SerializationError("Invalid name in the base file"s);
+        }
+        return names.substr(handle.offset, handle.length);
+    };
+
+    // Остановки
+    const uint32_t stops_count = reader.Read<uint32_t>();
+
+    for (uint32_t i = 0; i < stops_count; ++i) {
+        const string_view name = read_name();
+        geo::Coordinate coordinate;
+        coordinate.lat = reader.Read<double>();
+        coordinate.lng = reader.Read<double>();
+        catalogue.AddStop(name, coordinate);
+    }
+
+    if (catalogue.GetStops().size() != stops_count) {
+        throw SerializationError("Duplicate stop names in the base file"s);
+    }
+
+    auto read_stop_id = [&reader, stops_count] {
+        const StopId id = reader.Read<StopId>();
+        if (id >= stops_count) throw SerializationError("Invalid stop id in the base file"s);
+        return id;
+    };
+
+    // Маршруты
+    const uint32_t buses_count = reader.Read<uint32_t>();
+    vector<string_view> bus_stops;
+
+    for (uint32_t i = 0; i < buses_count; ++i) {
+        const string_view name = read_name();
+        const BusRouteType type = reader.Read<uint8_t>() ? BusRouteType::Circle : BusRouteType::Line;
+
+        const uint32_t bus_stops_count = reader.Read<uint32_t>();
+        bus_stops.clear();
+        for (uint32_t j = 0; j < bus_stops_count; ++j) {
+            bus_stops.push_back(catalogue.GetStop(read_stop_id()).name);
+        }
+
+        catalogue.AddBus(name, type, bus_stops);
+    }
+
+    // Расстояния
+    const uint32_t distances_count = reader.Read<uint32_t>();
+
+    for (uint32_t i = 0; i < distances_count; ++i) {
+        const StopId from = read_stop_id();
+        const StopId to   = read_stop_id();
+        catalogue.SetDistance(catalogue.GetStop(from).name, catalogue.GetStop(to).name, reader.Read<int32_t>());
+    }
+
+    // Настройки
+    BaseSettings settings;
+
+    if (reader.Read<uint8_t>()) {
+        settings.render_settings = ReadRenderSettings(reader);
+    }
+
+    if (reader.Read<uint8_t>()) {
+        transport_router::RoutingSettings routing_settings;
+        routing_settings.bus_wait_time = reader.Read<int32_t>();
+        routing_settings.bus_velocity  = reader.Read<double>();
+        settings.routing_settings = routing_settings;
+    }
+
+    if (!reader.IsEnd()) {
+        throw SerializationError("Unexpected data at the end of the base file"s);
+    }
+
+    return settings;
+}
+
+// Функция сохранения базы данных и настроек в бинарный файл
+void SaveBaseToFile(const string& file, const TransportCatalogue& catalogue, const BaseSettings& settings) {
+    ofstream output(file, ios::binary);
+    if (!output) throw SerializationError("Cannot open base file \""s + file + "\" for writing"s);
+
+    SaveBase(output, catalogue, settings);
+
+    if (!output) throw SerializationError("Cannot write base file \""s + file + "\""s);
+}
+
+// Функция загрузки базы данных из бинарного файла (файл читается целиком одним последовательным чтением)
+BaseSettings LoadBaseFromFile(const string& file, TransportCatalogue& catalogue) {
+    ifstream input(file, ios::binary | ios::ate);
+    if (!input) throw SerializationError("Cannot open base file \""s + file + "\""s);
+
+    string data(static_cast<size_t>(input.tellg()), '\0');
+    input.seekg(0);
+    input.read(data.data(), static_cast<streamsize>(data.size()));
+
+    if (!input) throw SerializationError("Cannot read base file \""s + file + "\""s);
+
+    return LoadBase(data, catalogue);
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include <thread>
+#include <mutex>
+#include <list>
+#include <iterator>
+#include <cstring>
+#include <cerrno>
+#include "server.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <signal.h>
+#include <pthread.h>
+#endif
+
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с работой справочника в режиме сервера
+namespace server {
+
+#ifndef _WIN32
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue::server
+namespace detail {
+
+// Флаги записи в сокет: разрыв соединения клиентом не должен завершать процесс сигналом SIGPIPE
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+// Соединение с клиентом, обслуживаемое отдельным потоком
+struct Connection {
+    int    descriptor = -1;
+    bool   finished   = false; // Обслуживание завершено, и дескриптор закрывается (под мьютексом соединений)
+    thread worker;
+};
+
+}
+
+DescriptorStreamBuf::DescriptorStreamBuf(int descriptor) : descriptor_(descriptor) {
+    setg(input_buffer_, input_buffer_, input_buffer_);
+    setp(output_buffer_, output_buffer_ + sizeof(output_buffer_));
+}
+
+DescriptorStreamBuf::~DescriptorStreamBuf() {
+    FlushOutput();
+    close(descriptor_);
+}
+
+DescriptorStreamBuf::int_type DescriptorStreamBuf::underflow() {
+    ssize_t count;
+    do {
+        count = recv(descriptor_, input_buffer_, sizeof(input_buffer_), 0);
+    } while (count < 0 && errno == EINTR);
+
+    if (count <= 0) return traits_type::eof();
+
+    setg(input_buffer_, input_buffer_, input_buffer_ + count);
+    return traits_type::to_int_type(input_buffer_[0]);
+}
+
+DescriptorStreamBuf::int_type DescriptorStreamBuf::overflow(int_type ch) {
+    if (!FlushOutput()) return traits_type::eof();
+
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(ch);
+}
+
+int DescriptorStreamBuf::sync() {
+    return FlushOutput() ? 0 : -1;
+}
+
+// Функция закрытия дескриптора на чтение: ожидающее чтение (в том числе в другом потоке) сразу получает конец потока
+void DescriptorStreamBuf::ShutdownInput() {
+    shutdown(descriptor_, SHUT_RD);
+}
+
+// Функция записи накопленного буфера вывода в дескриптор
+bool DescriptorStreamBuf::FlushOutput() {
+    const char* data = pbase();
+    size_t size = static_cast<size_t>(pptr() - pbase());
+
+    while (size > 0) {
+        const ssize_t count = send(descriptor_, data, size, detail::SEND_FLAGS);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+
+    setp(output_buffer_, output_buffer_ + sizeof(output_buffer_));
+    return true;
+}
+
+// Функция запуска сервера на Unix-сокете socket_path: каждое соединение обслуживается в своём потоке
+// функцией session. Функция не возвращает управление (кроме ошибки сокета; в этом случае все соединения
+// обрываются, и функция дожидается их потоков, прежде чем выбросить исключение)
+void ServeUnixSocket(const string& socket_path, const Session& session) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw ServerError("Socket path is too long: "s + socket_path);
+    }
+    memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) throw ServerError("Cannot create socket: "s + strerror(errno));
+
+    // Сокет, оставшийся от предыдущего запуска, заменяется
+    unlink(socket_path.c_str());
+
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+        const string error = strerror(errno);
+        close(listener);
+        throw ServerError("Cannot listen on socket "s + socket_path + ": "s + error);
+    }
+
+    // Потоки соединений ссылаются на session, поэтому они не отсоединяются, а дожидаются: завершённые - при каждом
+    // новом соединении, остальные - при выходе по ошибке
+    mutex connections_mutex;
+    list<detail::Connection> connections;
+
+    auto join_finished = [&] {
+        list<detail::Connection> finished;
+        {
+            lock_guard lock(connections_mutex);
+            for (auto it = connections.begin(); it != connections.end(); ) {
+                const auto next = std::next(it);
+                if (it->finished) finished.splice(finished.end(), connections, it);
+                it = next;
+            }
+        }
+
+        for (detail::Connection& connection : finished) connection.worker.join();
+    };
+
+    auto close_all = [&] {
+        {
+            lock_guard lock(connections_mutex);
+            for (const detail::Connection& connection : connections) {
+                if (!connection.finished) shutdown(connection.descriptor, SHUT_RDWR);
+            }
+        }
+
+        for (detail::Connection& connection : connections) connection.worker.join();
+        connections.clear();
+    };
+
+    try {
+        while (true) {
+            const int descriptor = accept(listener, nullptr, nullptr);
+            if (descriptor < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                throw ServerError("Cannot accept connection: "s + strerror(errno));
+            }
+
+            join_finished();
+
+            detail::Connection* connection;
+            {
+                lock_guard lock(connections_mutex);
+                connection = &connections.emplace_back();
+                connection->descriptor = descriptor;
+            }
+
+            // Справочник в режиме сервера только читается, поэтому соединения обслуживаются независимо
+            connection->worker = thread([&session, &connections_mutex, connection] {
+                DescriptorStreamBuf buffer(connection->descriptor);
+                istream input(&buffer);
+                ostream output(&buffer);
+
+                try {
+                    session(input, output, [&buffer] { buffer.ShutdownInput(); });
+                }
+                catch (const exception& e) {
+                    cerr << "Connection error: "sv << e.what() << endl;
+                }
+
+                // Отметка ставится до закрытия дескриптора (в деструкторе buffer), чтобы при выходе по ошибке
+                // не закрыть на чтение чужой дескриптор с тем же номером
+                lock_guard lock(connections_mutex);
+                connection->finished = true;
+            });
+        }
+    }
+    catch (...) {
+        close_all();
+        close(listener);
+        throw;
+    }
+}
+
+// Класс потока, который вызывает обработчики при получении сигналов SIGHUP и SIGUSR1. Сигналы блокируются в потоке,
+// создающем объект, а потоки, созданные после этого, наследуют маску сигналов, поэтому объект нужно создать до создания
+// остальных потоков
+SignalListener::SignalListener(SignalHandlers handlers) {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    sigaddset(&signals, SIGUSR1);
+
+    if (const int error = pthread_sigmask(SIG_BLOCK, &signals, nullptr); error != 0) {
+        throw ServerError("Cannot block signals: "s + strerror(error));
+    }
+
+    // Сигналы принимаются синхронно, поэтому в обработчиках можно делать что угодно (а не только то, что допустимо в обработчике сигнала)
+    thread_ = thread([this, signals, handlers = move(handlers)] {
+        while (true) {
+            int signal = 0;
+            if (sigwait(&signals, &signal) != 0) continue;
+            if (stopped_) return;
+
+            if (signal == SIGHUP && handlers.reload) handlers.reload();
+            if (signal == SIGUSR1 && handlers.dump_metrics) handlers.dump_metrics();
+        }
+    });
+}
+
+// Деструктор останавливает поток: отправленный ему сигнал прерывает ожидание, и поток видит флаг остановки
+SignalListener::~SignalListener() {
+    stopped_ = true;
+    pthread_kill(thread_.native_handle(), SIGHUP);
+    thread_.join();
+}
+
+#else
+
+// Функция запуска сервера на Unix-сокете (на Windows не поддерживается)
+void ServeUnixSocket(const string& socket_path, const Session&) {
+    throw ServerError("Unix sockets are not supported on this platform: "s + socket_path);
+}
+
+// Обработка сигналов (на Windows сигналов SIGHUP и SIGUSR1 нет, поэтому поток не создаётся)
+SignalListener::SignalListener(SignalHandlers) { }
+
+SignalListener::~SignalListener() { }
+
+#endif
+
+}
+
+}
\ No newline at end of file
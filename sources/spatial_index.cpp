@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "spatial_index.h"
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с пространственным поиском остановок
+namespace spatial_index {
+
+SpatialIndex::SpatialIndex(const TransportCatalogue& catalogue) : catalogue_(catalogue) {
+    Build();
+}
+
+// Функция обновления остановок stops после изменения справочника (новых, перемещённых или удалённых).
+// Остановка исключается со своего места, а если она не удалена, добавляется в список изменённых
+void SpatialIndex::Update(const vector<StopId>& stops) {
+    const auto& all_stops = catalogue_.GetStops();
+    positions_.resize(all_stops.size(), NO_POSITION);
+
+    for (StopId id : stops) {
+        Erase(id);
+
+        if (catalogue_.IsStopRemoved(id)) continue;
+
+        positions_[id] = EXTRA_POSITION | static_cast<uint32_t>(extra_stops_.size());
+        extra_stops_.push_back(id);
+        extra_coordinates_.push_back(all_stops[id].coordinate);
+    }
+
+    // Список изменённых просматривается при каждом поиске, поэтому, когда он разрастается, сетка строится заново
+    if (extra_stops_.size() + removed_count_ > max<size_t>(64u, cell_stops_.size() / 8u)) {
+        Build();
+    }
+}
+
+// Функция построения сетки по всем остановкам справочника
+void SpatialIndex::Build() {
+    const auto& stops = catalogue_.GetStops();
+
+    cell_stops_.clear();
+    cell_coordinates_.clear();
+    extra_stops_.clear();
+    extra_coordinates_.clear();
+    removed_count_ = 0;
+    positions_.assign(stops.size(), NO_POSITION);
+
+    // Удалённые остановки в индекс не попадают
+    vector<StopId> ids;
+    ids.reserve(stops.size());
+
+    for (StopId id = 0; id < stops.size(); ++id) {
+        if (!catalogue_.IsStopRemoved(id)) ids.push_back(id);
+    }
+
+    if (ids.empty()) {
+        rows_    = 1;
+        columns_ = 1;
+        cell_offsets_.assign(2, 0u);
+        return;
+    }
+
+    // Находим границы области, в которой лежат остановки
+    const auto [bottom_it, top_it] = minmax_element(ids.begin(), ids.end(),
+                                                    [&stops](StopId lhs, StopId rhs) { return stops[lhs].coordinate.lat < stops[rhs].coordinate.lat; });
+    const auto [left_it, right_it] = minmax_element(ids.begin(), ids.end(),
+                                                    [&stops](StopId lhs, StopId rhs) { return stops[lhs].coordinate.lng < stops[rhs].coordinate.lng; });
+
+    min_lat_ = stops[*bottom_it].coordinate.lat;
+    min_lng_ = stops[*left_it].coordinate.lng;
+
+    const double lat_span = stops[*top_it].coordinate.lat   - min_lat_;
+    const double lng_span = stops[*right_it].coordinate.lng - min_lng_;
+
+    // Размер сетки подбирается так, чтобы в ячейке было в среднем около двух остановок
+    const uint32_t side = max(1u, static_cast<uint32_t>(sqrt(ids.size() / 2.0)));
+    rows_    = side;
+    columns_ = side;
+
+    // Небольшой запас, чтобы крайние остановки попадали внутрь сетки
+    cell_lat_ = lat_span > 0.0 ? lat_span * 1.000001 / rows_    : 1.0;
+    cell_lng_ = lng_span > 0.0 ? lng_span * 1.000001 / columns_ : 1.0;
+
+    // Раскладываем остановки по ячейкам (сортировка подсчётом)
+    const size_t cells_count = static_cast<size_t>(rows_) * columns_;
+    vector<uint32_t> stop_cells(stops.size());
+
+    cell_offsets_.assign(cells_count + 1, 0u);
+
+    for (StopId id : ids) {
+        stop_cells[id] = GetRow(stops[id].coordinate.lat) * columns_ + GetColumn(stops[id].coordinate.lng);
+        ++cell_offsets_[stop_cells[id] + 1];
+    }
+
+    for (size_t i = 1; i < cell_offsets_.size(); ++i) {
+        cell_offsets_[i] += cell_offsets_[i - 1];
+    }
+
+    cell_stops_.resize(ids.size());
+    cell_coordinates_.resize(ids.size());
+
+    vector<uint32_t> positions(cell_offsets_.begin(), cell_offsets_.end() - 1);
+
+    for (StopId id : ids) {
+        const uint32_t position = positions[stop_cells[id]]++;
+        cell_stops_[position]       = id;
+        cell_coordinates_[position] = stops[id].coordinate;
+        positions_[id]              = position;
+    }
+}
+
+// Функция исключения остановки из индекса
+void SpatialIndex::Erase(StopId id) {
+    const uint32_t position = positions_[id];
+    if (position == NO_POSITION) return;
+
+    positions_[id] = NO_POSITION;
+
+    if (!(position & EXTRA_POSITION)) {
+        // Место в сетке остаётся, но никогда не проходит проверку попадания в прямоугольник
+        cell_coordinates_[position].lat = numeric_limits<double>::infinity();
+        ++removed_count_;
+        return;
+    }
+
+    // Из списка изменённых остановка удаляется заменой на последнюю
+    const uint32_t index = position & ~EXTRA_POSITION;
+
+    extra_stops_[index]       = extra_stops_.back();
+    extra_coordinates_[index] = extra_coordinates_.back();
+    extra_stops_.pop_back();
+    extra_coordinates_.pop_back();
+
+    if (index < extra_stops_.size()) {
+        positions_[extra_stops_[index]] = EXTRA_POSITION | index;
+    }
+}
+
+// Функция получения номера строки сетки по широте
+uint32_t SpatialIndex::GetRow(double lat) const {
+    const double row = floor((lat - min_lat_) / cell_lat_);
+    return static_cast<uint32_t>(clamp(row, 0.0, static_cast<double>(rows_ - 1)));
+}
+
+// Функция получения номера столбца сетки по долготе
+uint32_t SpatialIndex::GetColumn(double lng) const {
+    const double column = floor((lng - min_lng_) / cell_lng_);
+    return static_cast<uint32_t>(clamp(column, 0.0, static_cast<double>(columns_ - 1)));
+}
+
+// Функция поиска остановок на расстоянии не более radius метров от точки center.
+// Результат упорядочен по расстоянию (при равенстве - по названию), память result переиспользуется
+void SpatialIndex::FindStopsNearby(const geo::Coordinate& center, double radius, vector<NearbyStop>& result) const {
+    using namespace geo;
+
+    result.clear();
+
+    if (radius < 0.0) return;
+
+    // Описанный вокруг круга прямоугольник в градусах (с запасом на погрешность вычислений);
+    // переход через 180-й меридиан не учитывается, так как индекс рассчитан на масштаб города
+    const double delta_lat = radius / EARTH_RADIUS / DEG_TO_RAD * 1.001;
+    const double cos_lat   = cos(min(abs(center.lat) + delta_lat, 89.999) * DEG_TO_RAD);
+    const double delta_lng = delta_lat / cos_lat;
+
+    const double min_lat = center.lat - delta_lat;
+    const double max_lat = center.lat + delta_lat;
+    const double min_lng = center.lng - delta_lng;
+    const double max_lng = center.lng + delta_lng;
+
+    auto check_stop = [&](StopId id, const Coordinate& coordinate) {
+        // Дешёвая проверка попадания в прямоугольник перед вычислением расстояния
+        if (coordinate.lat < min_lat || coordinate.lat > max_lat || coordinate.lng < min_lng || coordinate.lng > max_lng) return;
+
+        const double distance = ComputeDistance(center, coordinate);
+        if (distance <= radius) {
+            result.push_back({ catalogue_.GetStop(id).name, distance });
+        }
+    };
+
+    // Ячейки просматриваются, если прямоугольник пересекает сетку
+    if (!cell_stops_.empty() &&
+        max_lat >= min_lat_ && min_lat <= min_lat_ + cell_lat_ * rows_ &&
+        max_lng >= min_lng_ && min_lng <= min_lng_ + cell_lng_ * columns_) {
+        const uint32_t first_row    = GetRow(min_lat);
+        const uint32_t last_row     = GetRow(max_lat);
+        const uint32_t first_column = GetColumn(min_lng);
+        const uint32_t last_column  = GetColumn(max_lng);
+
+        for (uint32_t row = first_row; row <= last_row; ++row) {
+            // Ячейки одной строки сетки лежат подряд, поэтому их остановки - один непрерывный участок
+            const uint32_t begin = cell_offsets_[row * columns_ + first_column];
+            const uint32_t end   = cell_offsets_[row * columns_ + last_column + 1];
+
+            for (uint32_t position = begin; position < end; ++position) {
+                check_stop(cell_stops_[position], cell_coordinates_[position]);
+            }
+        }
+    }
+
+    // Изменённые после построения сетки остановки могут лежать и вне её
+    for (size_t n = 0; n < extra_stops_.size(); ++n) {
+        check_stop(extra_stops_[n], extra_coordinates_[n]);
+    }
+
+    sort(result.begin(), result.end(), [](const NearbyStop& lhs, const NearbyStop& rhs) {
+        return lhs.distance < rhs.distance || (lhs.distance == rhs.distance && lhs.name < rhs.name);
+    });
+}
+
+}
+
+}
\ No newline at end of file
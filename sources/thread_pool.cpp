@@ -0,0 +1,62 @@
+#include "thread_pool.h"
+
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с многопоточной обработкой запросов
+namespace threading {
+
+ThreadPool::ThreadPool(size_t threads_count) {
+    threads_.reserve(threads_count);
+    for (size_t i = 0; i < threads_count; ++i) {
+        threads_.emplace_back([this] { Work(); });
+    }
+}
+
+// Деструктор дожидается выполнения всех добавленных задач
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard lock(m_);
+        stopped_ = true;
+    }
+    task_ready_.notify_all();
+
+    for (thread& t : threads_) t.join();
+}
+
+// Функция добавления задачи в очередь
+void ThreadPool::Submit(function<void()> task) {
+    {
+        lock_guard lock(m_);
+        tasks_.push_back(move(task));
+    }
+    task_ready_.notify_one();
+}
+
+// Функция получения числа потоков пула
+size_t ThreadPool::GetThreadsCount() const {
+    return threads_.size();
+}
+
+// Функция потока пула: выполняет задачи, пока пул не остановлен и очередь не опустела
+void ThreadPool::Work() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock lock(m_);
+            task_ready_.wait(lock, [this] { return stopped_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;
+
+            task = move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        task();
+    }
+}
+
+}
+
+}
\ No newline at end of file
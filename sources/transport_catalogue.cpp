@@ -1,4 +1,7 @@
 #include <stdexcept>
+#include <algorithm>
+#include <tuple>
+#include <set>
 #include "transport_catalogue.h"
 using namespace std;
 
@@ -8,17 +11,279 @@ namespace transport_catalogue {
 // Пространство имён для структур и функций, использующихся только для внутренней работы класса transport_catalogue
 namespace detail {
 
-// Хешер для ключа pair<const Stop*, const Stop*> в unordered_map
-size_t PairStopStopHasher::operator() (const pair<const Stop*, const Stop*>& stops) const {
-	constexpr size_t simp_mult = 37u;
+// Функция добавления названия маршрута в упорядоченный список маршрутов остановки (повторно не добавляется)
+void InsertBusName(vector<string_view>& buses, string_view name) {
+	const auto it = lower_bound(buses.begin(), buses.end(), name);
+	if (it == buses.end() || *it != name) buses.insert(it, name);
+}
+
+// Функция удаления названия маршрута из упорядоченного списка маршрутов остановки
+void EraseBusName(vector<string_view>& buses, string_view name) {
+	const auto it = lower_bound(buses.begin(), buses.end(), name);
+	if (it != buses.end() && *it == name) buses.erase(it);
+}
+
+// Функция задания расстояния от остановки from до остановки to (повторное задание перезаписывает значение)
+void DistancesTable::Set(StopId from, StopId to, int distance) {
+	// После построения CSR явно заданные расстояния хранятся только в нём
+	if (is_built_) records_ = GetRecords();
+
+	records_.push_back({ from, to, distance });
+	is_built_ = false;
+}
+
+// Функция построения CSR-представления для stops_count остановок (расстояния в обратную сторону достраиваются здесь же)
+void DistancesTable::Build(size_t stops_count) {
+	auto by_stops = [](const Record& lhs, const Record& rhs) {
+		return tie(lhs.from, lhs.to) < tie(rhs.from, rhs.to);
+	};
+
+	// Оставляем только последнее заданное значение для каждой пары остановок
+	// (stable_sort сохраняет порядок задания внутри одинаковых пар)
+	stable_sort(records_.begin(), records_.end(), by_stops);
+
+	vector<Record> unique_records;
+	unique_records.reserve(records_.size());
+
+	for (size_t i = 0; i < records_.size(); ++i) {
+		if (i + 1 < records_.size() && records_[i].from == records_[i + 1].from && records_[i].to == records_[i + 1].to) continue;
+		unique_records.push_back(records_[i]);
+	}
+
+	// Достраиваем расстояния в обратную сторону там, где они не заданы явно
+	vector<pair<Record, bool>> all_records;
+	all_records.reserve(unique_records.size() * 2);
+
+	for (const Record& record : unique_records) {
+		all_records.push_back({ record, true });
+
+		const Record reversed{ record.to, record.from, record.distance };
+		if (!binary_search(unique_records.begin(), unique_records.end(), reversed, by_stops)) {
+			all_records.push_back({ reversed, false });
+		}
+	}
+
+	sort(all_records.begin(), all_records.end(), [&by_stops](const auto& lhs, const auto& rhs) { return by_stops(lhs.first, rhs.first); });
+
+	// Формируем CSR-представление
+	offsets_.assign(stops_count + 1, 0u);
+	edges_.clear();
+	edges_.reserve(all_records.size());
+
+	for (const auto& [record, is_explicit] : all_records) {
+		++offsets_[record.from + 1];
+		edges_.push_back({ record.to, Value{ record.distance, is_explicit } });
+	}
+
+	for (size_t i = 1; i < offsets_.size(); ++i) {
+		offsets_[i] += offsets_[i - 1];
+	}
+
+	// Явно заданные расстояния теперь хранятся в CSR
+	records_.clear();
+	records_.shrink_to_fit();
+
+	added_.clear();
+	removed_count_ = 0;
+	stops_count_ = stops_count;
+	is_built_ = true;
+}
+
+// Функция получения расстояния от остановки from до остановки to (если прямого нет, то берётся обратное)
+optional<int> DistancesTable::Get(StopId from, StopId to) const {
+	if (!is_built_) {
+		if (const auto distance = FindRecord(from, to)) return distance;
+		return FindRecord(to, from);
+	}
+
+	if (const Value* value = FindValue(from, to)) return value->distance;
+	return nullopt;
+}
+
+// Функция получения явно заданного расстояния от остановки from до остановки to (без подстановки обратного)
+optional<int> DistancesTable::GetExplicit(StopId from, StopId to) const {
+	if (!is_built_) return FindRecord(from, to);
+
+	if (const Value* value = FindValue(from, to); value && value->is_explicit) return value->distance;
+	return nullopt;
+}
+
+// Функция получения явно заданных расстояний (после построения CSR - по одному на пару остановок, по порядку пар)
+vector<RoadDistance> DistancesTable::GetRecords() const {
+	if (!is_built_) return records_;
+
+	vector<Record> result;
+	result.reserve(edges_.size() - removed_count_ + added_.size());
+
+	for (StopId from = 0; from + 1u < offsets_.size(); ++from) {
+		for (uint32_t e = offsets_[from]; e < offsets_[from + 1]; ++e) {
+			if (edges_[e].value.distance != NO_DISTANCE && edges_[e].value.is_explicit) {
+				result.push_back({ from, edges_[e].to, edges_[e].value.distance });
+			}
+		}
+	}
+
+	// Расстояния, заданные после построения CSR, встраиваются в общий порядок пар
+	if (!added_.empty()) {
+		for (const auto& [key, value] : added_) {
+			if (value.is_explicit) {
+				result.push_back({ static_cast<StopId>(key >> 32), static_cast<StopId>(key & 0xFFFFFFFFu), value.distance });
+			}
+		}
+
+		sort(result.begin(), result.end(), [](const Record& lhs, const Record& rhs) {
+			return tie(lhs.from, lhs.to) < tie(rhs.from, rhs.to);
+		});
+	}
+
+	return result;
+}
+
+// Функция изменения явно заданного расстояния от остановки from до остановки to (nullopt - удаление) без перестроения CSR.
+// Расстояние в обратную сторону, если оно не задано явно, меняется вместе с прямым
+void DistancesTable::Update(StopId from, StopId to, optional<int> distance) {
+	if (!is_built_) {
+		if (distance) {
+			records_.push_back({ from, to, *distance });
+		}
+		else {
+			records_.erase(remove_if(records_.begin(), records_.end(), [from, to](const Record& record) {
+				return record.from == from && record.to == to;
+			}), records_.end());
+		}
+		return;
+	}
+
+	stops_count_ = max<size_t>(stops_count_, max(from, to) + 1u);
+
+	// Расстояние от остановки до неё же обратного не имеет
+	const Value* reversed = from != to ? FindValue(to, from) : nullptr;
+	const bool is_reversed_explicit = reversed && reversed->is_explicit;
+
+	if (distance) {
+		SetValue(from, to, { *distance, true });
+		if (!is_reversed_explicit && from != to) SetValue(to, from, { *distance, false });
+	}
+	else {
+		const Value* direct = FindValue(from, to);
+		if (!direct || !direct->is_explicit) return;
+
+		// Без прямого расстояния в эту сторону действует обратное, если оно задано явно
+		if (is_reversed_explicit) {
+			SetValue(from, to, { reversed->distance, false });
+		}
+		else {
+			EraseValue(from, to);
+			if (from != to) EraseValue(to, from);
+		}
+	}
+
+	CompactIfNeeded();
+}
+
+// Функция удаления всех расстояний от остановки и до неё
+void DistancesTable::Remove(StopId stop) {
+	if (!is_built_) {
+		records_.erase(remove_if(records_.begin(), records_.end(), [stop](const Record& record) {
+			return record.from == stop || record.to == stop;
+		}), records_.end());
+		return;
+	}
 
-	// size_t first_hash  = hash<Stop*>{}(stops.first);
-	// size_t second_hash = hash<Stop*>{}(stops.second);
+	// Рёбра CSR есть в обе стороны, поэтому соседей достаточно взять из участка самой остановки
+	vector<StopId> neighbours;
 
-	size_t first_hash  = reinterpret_cast<size_t>(stops.first);
-	size_t second_hash = reinterpret_cast<size_t>(stops.second);
+	if (stop + 1u < offsets_.size()) {
+		for (uint32_t e = offsets_[stop]; e < offsets_[stop + 1]; ++e) {
+			if (edges_[e].value.distance != NO_DISTANCE) neighbours.push_back(edges_[e].to);
+		}
+	}
+
+	for (const auto& [key, value] : added_) {
+		if (static_cast<StopId>(key >> 32) == stop) neighbours.push_back(static_cast<StopId>(key & 0xFFFFFFFFu));
+	}
+
+	for (StopId neighbour : neighbours) {
+		EraseValue(stop, neighbour);
+		EraseValue(neighbour, stop);
+	}
+
+	CompactIfNeeded();
+}
+
+// Функция поиска явно заданного расстояния (используется, пока CSR не построено)
+optional<int> DistancesTable::FindRecord(StopId from, StopId to) const {
+	// Идём с конца, так как более позднее задание перезаписывает более раннее
+	for (auto it = records_.rbegin(); it != records_.rend(); ++it) {
+		if (it->from == from && it->to == to) return it->distance;
+	}
+	return nullopt;
+}
+
+// Функция поиска ребра CSR (в том числе удалённого)
+const DistancesTable::Edge* DistancesTable::FindEdge(StopId from, StopId to) const {
+	if (from + 1u >= offsets_.size()) return nullptr;
+
+	const auto begin = edges_.begin() + offsets_[from];
+	const auto end   = edges_.begin() + offsets_[from + 1];
+
+	const auto it = lower_bound(begin, end, to, [](const Edge& edge, StopId stop) { return edge.to < stop; });
+	if (it == end || it->to != to) return nullptr;
+
+	return &*it;
+}
+
+// Функция поиска значения расстояния после построения CSR (в CSR или среди добавленных позже)
+const DistancesTable::Value* DistancesTable::FindValue(StopId from, StopId to) const {
+	if (const Edge* edge = FindEdge(from, to)) {
+		return edge->value.distance != NO_DISTANCE ? &edge->value : nullptr;
+	}
+
+	if (added_.empty()) return nullptr;
+
+	const auto it = added_.find(MakeKey(from, to));
+	return it != added_.end() ? &it->second : nullptr;
+}
+
+// Функция изменения значения расстояния после построения CSR
+void DistancesTable::SetValue(StopId from, StopId to, Value value) {
+	// Пара, для которой есть ребро CSR (даже удалённое), меняется на месте
+	if (const Edge* edge = FindEdge(from, to)) {
+		Edge& mutable_edge = edges_[edge - edges_.data()];
+		if (mutable_edge.value.distance == NO_DISTANCE) --removed_count_;
+		mutable_edge.value = value;
+		return;
+	}
+
+	added_[MakeKey(from, to)] = value;
+}
+
+// Функция удаления значения расстояния после построения CSR
+void DistancesTable::EraseValue(StopId from, StopId to) {
+	if (const Edge* edge = FindEdge(from, to)) {
+		Edge& mutable_edge = edges_[edge - edges_.data()];
+		if (mutable_edge.value.distance != NO_DISTANCE) ++removed_count_;
+		mutable_edge.value = { NO_DISTANCE, false };
+		return;
+	}
+
+	added_.erase(MakeKey(from, to));
+}
+
+// Функция перестроения CSR, если изменений накопилось слишком много. Порог пропорционален размеру CSR,
+// поэтому перестроение в среднем добавляет к каждому изменению лишь постоянное время
+void DistancesTable::CompactIfNeeded() {
+	const size_t changes = added_.size() + removed_count_;
+	if (changes <= max<size_t>(1024u, edges_.size() / 8u)) return;
+
+	records_ = GetRecords();
+	is_built_ = false;
+	Build(stops_count_);
+}
 
-	return first_hash + simp_mult * second_hash;
+// Функция получения ключа пары остановок
+uint64_t DistancesTable::MakeKey(StopId from, StopId to) {
+	return (static_cast<uint64_t>(from) << 32) | to;
 }
 
 }
@@ -27,65 +292,309 @@ size_t PairStopStopHasher::operator() (const pair<const Stop*, const Stop*>& sto
 void TransportCatalogue::AddStop(string_view name, const geo::Coordinate& coordinate) {
 	using namespace detail;
 
-	stops_.push_back({ string(name), coordinate });
-	stopname_to_stop_[stops_.back().name] = &stops_.back();
+	Unfreeze();
+
+	const StopId id = InternStop(name);
+
+	stops_[id].coordinate = coordinate;
+	stops_state_[id] = StopState::Defined;
 }
 
 // Функция добавления маршрута в базу данных
 void TransportCatalogue::AddBus(string_view name, BusRouteType type, const vector<string_view>& stops) {
 	using namespace detail;
 
-	vector<Stop*> stops_ptrs;
+	Unfreeze();
+
+	const BusId id = static_cast<BusId>(buses_.size());
+
+	vector<StopId> stops_ids;
+	stops_ids.reserve(stops.size());
 
 	for (string_view stop : stops) {
-		stops_ptrs.push_back(stopname_to_stop_[stop]);
+		stops_ids.push_back(InternStop(stop));
 	}
 
-	buses_.push_back({ string(name), stops_ptrs, type });
-	busname_to_bus_[buses_.back().name] = &buses_.back();
+	string_view stored_name = names_.Add(name);
 
-	for (string_view stop : stops) {
-		buses_on_stop_[stopname_to_stop_[stop]].insert(buses_.back().name);
+	for (StopId stop_id : stops_ids) {
+		detail::InsertBusName(buses_on_stop_[stop_id], stored_name);
 	}
+
+	buses_.push_back({ stored_name, move(stops_ids), type });
+	busname_to_id_.Set(stored_name, id);
 }
 
 // Функция добавления расстояния от остановки с именем stop_from до остановки с именем stop_to
 void TransportCatalogue::SetDistance(std::string_view stop_from, std::string_view stop_to, int distance) {
 	using namespace detail;
 
-	distances_[{stopname_to_stop_[stop_from], stopname_to_stop_[stop_to]}] = distance;
+	Unfreeze();
+
+	distances_.Set(InternStop(stop_from), InternStop(stop_to), distance);
 }
 
-// Функция получения константной ссылки на контейнер остановок (нужна для модуля map_renderer)
-const deque<Stop>& TransportCatalogue::GetStops() const {
-	return stops_;
+// Функция добавления остановки или изменения её координат
+void TransportCatalogue::UpdateStop(string_view name, const geo::Coordinate& coordinate) {
+	if (!is_frozen_) {
+		AddStop(name, coordinate);
+		return;
+	}
+
+	++version_;
+
+	// Новая остановка сразу добавлена, поэтому база остаётся полной
+	const StopId id = InternStop(name);
+
+	stops_[id].coordinate = coordinate;
+	stops_state_[id] = StopState::Defined;
+
+	UpdateBusesInfo(id);
 }
 
-// Функция получения словаря "Имя остановки" -> "Константный указатель на остановку в базе данных" (нужна для модуля map_renderer)
-const map<string_view, const Stop*> TransportCatalogue::GetStopnameToStopMap() const {
-	map<string_view, const Stop*> result;
+// Функция удаления остановки вместе с расстояниями от неё и до неё (через остановку не должны проходить маршруты).
+// Возвращает false, если остановки нет в базе
+bool TransportCatalogue::RemoveStop(string_view name) {
+	const auto id = FindStopId(name);
+	if (!id) return false;
 
-	for(const auto& [stop_name, stop_ptr] : stopname_to_stop_) {
-		result[stop_name] = stop_ptr;
+	if (!buses_on_stop_[*id].empty()) {
+		throw invalid_argument("Stop \""s + string(name) + "\" cannot be removed: buses pass through it"s);
 	}
 
-	return result;
+	++version_;
+
+	distances_.Remove(*id);
+
+	// Идентификатор остановки не переиспользуется, а название освобождается
+	stops_state_[*id] = StopState::Removed;
+	stopname_to_id_.Erase(stops_[*id].name);
+
+	return true;
 }
 
-// Функция получения словаря "Имя маршрута" -> "Константный указатель на маршрут в базе данных" (нужна для модуля map_renderer)
-const map<string_view, const Bus*> TransportCatalogue::GetBusnameToBusMap() const {
-	map<string_view, const Bus*> result;
+// Функция добавления маршрута или замены его остановок и типа
+void TransportCatalogue::UpdateBus(string_view name, BusRouteType type, const vector<string_view>& stops) {
+	const auto id = FindBusId(name);
 
-	for(const auto& [bus_name, bus_ptr] : busname_to_bus_) {
-		result[bus_name] = bus_ptr;
+	if (!is_frozen_ && !id) {
+		AddBus(name, type, stops);
+		return;
 	}
 
-	return result;
+	// В замороженную базу маршрут может ссылаться только на добавленные остановки с заданными расстояниями
+	vector<StopId> stops_ids;
+	stops_ids.reserve(stops.size());
+
+	for (string_view stop : stops) {
+		stops_ids.push_back(is_frozen_ ? GetDefinedStopId(stop) : InternStop(stop));
+	}
+
+	if (is_frozen_) {
+		CheckBusDistances(name, stops_ids);
+	}
+
+	++version_;
+
+	if (!id) {
+		// Новый маршрут в замороженной базе
+		const BusId new_id = static_cast<BusId>(buses_.size());
+		string_view stored_name = names_.Add(name);
+
+		for (StopId stop_id : stops_ids) {
+			detail::InsertBusName(buses_on_stop_[stop_id], stored_name);
+		}
+
+		buses_.push_back({ stored_name, move(stops_ids), type });
+		busname_to_id_.Set(stored_name, new_id);
+		buses_info_.push_back(ComputeBusInfo(buses_[new_id], ComputePathLength(buses_[new_id])));
+		return;
+	}
+
+	// Маршрут меняется на месте, а его название переносится со старых остановок на новые
+	Bus& bus = buses_[*id];
+
+	for (StopId stop_id : bus.stops) {
+		detail::EraseBusName(buses_on_stop_[stop_id], bus.name);
+	}
+
+	for (StopId stop_id : stops_ids) {
+		detail::InsertBusName(buses_on_stop_[stop_id], bus.name);
+	}
+
+	bus.stops = move(stops_ids);
+	bus.type  = type;
+
+	if (is_frozen_) {
+		buses_info_[*id] = ComputeBusInfo(bus, ComputePathLength(bus));
+	}
+}
+
+// Функция удаления маршрута. Возвращает false, если маршрута нет в базе
+bool TransportCatalogue::RemoveBus(string_view name) {
+	const auto id = FindBusId(name);
+	if (!id) return false;
+
+	++version_;
+
+	Bus& bus = buses_[*id];
+
+	for (StopId stop_id : bus.stops) {
+		detail::EraseBusName(buses_on_stop_[stop_id], bus.name);
+	}
+
+	// Идентификатор маршрута не переиспользуется: без названия в индексе маршрут считается удалённым
+	busname_to_id_.Erase(bus.name);
+	bus.stops.clear();
+
+	return true;
+}
+
+// Функция задания или изменения расстояния от остановки с именем stop_from до остановки с именем stop_to
+void TransportCatalogue::UpdateDistance(string_view stop_from, string_view stop_to, int distance) {
+	if (!is_frozen_) {
+		SetDistance(stop_from, stop_to, distance);
+		return;
+	}
+
+	const StopId from = GetDefinedStopId(stop_from);
+	const StopId to   = GetDefinedStopId(stop_to);
+
+	++version_;
+
+	distances_.Update(from, to, distance);
+
+	// Расстояние используется только маршрутами, проходящими через обе остановки
+	UpdateBusesInfo(from);
+}
+
+// Функция удаления явно заданного расстояния от остановки с именем stop_from до остановки с именем stop_to
+// (если задано обратное, оно начинает действовать в обе стороны). Возвращает false, если расстояние не было задано
+bool TransportCatalogue::RemoveDistance(string_view stop_from, string_view stop_to) {
+	const auto from = FindStopId(stop_from);
+	const auto to   = FindStopId(stop_to);
+
+	if (!from || !to || !distances_.GetExplicit(*from, *to)) return false;
+
+	// Если обратного расстояния нет, пара остановок остаётся без расстояния, а в замороженной базе
+	// его не должен использовать ни один маршрут
+	if (is_frozen_ && !distances_.GetExplicit(*to, *from)) {
+		for (string_view bus_name : buses_on_stop_[*from]) {
+			const auto bus_id = FindBusId(bus_name);
+			if (!bus_id) continue;
+
+			const vector<StopId>& stops = buses_[*bus_id].stops;
+
+			for (size_t n = 0; n + 1 < stops.size(); ++n) {
+				if ((stops[n] == *from && stops[n + 1] == *to) || (stops[n] == *to && stops[n + 1] == *from)) {
+					throw invalid_argument("Distance from \""s + string(stop_from) + "\" to \""s + string(stop_to)
+					                       + "\" cannot be removed: bus \""s + string(bus_name) + "\" uses it"s);
+				}
+			}
+		}
+	}
+
+	++version_;
+
+	distances_.Update(*from, *to, nullopt);
+
+	if (is_frozen_) {
+		UpdateBusesInfo(*from);
+	}
+
+	return true;
+}
+
+// Функция получения идентификатора остановки по названию (если остановки ещё нет, под неё резервируется идентификатор)
+StopId TransportCatalogue::InternStop(string_view name) {
+	if (const auto id = stopname_to_id_.Find(name)) {
+		return *id;
+	}
+
+	const StopId id = static_cast<StopId>(stops_.size());
+
+	string_view stored_name = names_.Add(name);
+
+	stops_.push_back({ stored_name, { 0.0, 0.0 } });
+	stops_state_.push_back(StopState::Referenced);
+	buses_on_stop_.emplace_back();
+	stopname_to_id_.Set(stored_name, id);
+
+	return id;
+}
+
+// Функция получения константной ссылки на контейнер остановок (нужна для модуля map_renderer)
+const vector<Stop>& TransportCatalogue::GetStops() const {
+	return stops_;
+}
+
+// Функция проверки, что остановка с данным идентификатором удалена из базы
+bool TransportCatalogue::IsStopRemoved(StopId id) const {
+	return stops_state_[id] == StopState::Removed;
+}
+
+// Функция получения константной ссылки на контейнер маршрутов
+const vector<Bus>& TransportCatalogue::GetBuses() const {
+	return buses_;
+}
+
+// Функция получения пула названий остановок и маршрутов (названия в Stop и Bus указывают в него, нужна для модуля serialization)
+const NamePool& TransportCatalogue::GetNamePool() const {
+	return names_;
+}
+
+// Функция резервирования места под size байт названий (если суммарный размер названий известен заранее,
+// например при загрузке из бинарного файла, все названия окажутся в одном непрерывном блоке)
+void TransportCatalogue::ReserveNames(size_t size) {
+	names_.Reserve(size);
+}
+
+// Функция получения остановки по её идентификатору
+const Stop& TransportCatalogue::GetStop(StopId id) const {
+	return stops_[id];
+}
+
+// Функция получения маршрута по его идентификатору
+const Bus& TransportCatalogue::GetBus(BusId id) const {
+	return buses_[id];
+}
+
+// Функция поиска идентификатора остановки по её названию
+optional<StopId> TransportCatalogue::FindStopId(string_view name) const {
+	return stopname_to_id_.Find(name);
+}
+
+// Функция поиска идентификатора маршрута по его названию
+optional<BusId> TransportCatalogue::FindBusId(string_view name) const {
+	return busname_to_id_.Find(name);
+}
+
+// Функция получения дорожного расстояния между остановками (если прямого нет, то берётся обратное)
+optional<int> TransportCatalogue::GetDistance(StopId from, StopId to) const {
+	return distances_.Get(from, to);
+}
+
+// Функция получения явно заданного дорожного расстояния между остановками (без подстановки обратного)
+optional<int> TransportCatalogue::GetExplicitDistance(StopId from, StopId to) const {
+	return distances_.GetExplicit(from, to);
+}
+
+// Функция получения явно заданных дорожных расстояний (после заморозки - по одному на пару остановок, нужна для модуля serialization)
+vector<RoadDistance> TransportCatalogue::GetRoadDistances() const {
+	return distances_.GetRecords();
 }
 
 // Функция наличия маршрутов на остановке
 bool TransportCatalogue::IfBusesOnStop(string_view name) const {
-	return !buses_on_stop_.at(stopname_to_stop_.at(name)).empty();
+	const auto id = FindStopId(name);
+	if (!id) throw out_of_range("Stop \""s + string(name) + "\" is not found"s);
+
+	return !buses_on_stop_[*id].empty();
+}
+
+// Функция наличия маршрутов на остановке по её идентификатору
+bool TransportCatalogue::IfBusesOnStop(StopId id) const {
+	return !buses_on_stop_[id].empty();
 }
 
 // Функция получения информации об остановке
@@ -93,22 +602,13 @@ optional<StopInfo> TransportCatalogue::GetStopInfo(string_view name) const {
 	using namespace detail;
 
 	// Если остановки нету в базе данных
-	if(!stopname_to_stop_.count(name)) {
+	const auto stop_id = FindStopId(name);
+	if (!stop_id) {
 		return nullopt;
 	}
 
-	// Указатель на остановку в базе данных
-	const Stop* stop_ptr = stopname_to_stop_.at(name);
-
-	// Если через остановку не проходит ни один маршрут
-	if (!buses_on_stop_.count(stop_ptr)) {
-		return StopInfo{ stop_ptr->name, vector<string_view>{} };
-	}
-
-	const auto& buses_on_stop_set = buses_on_stop_.at(stop_ptr);
-
-	// Формирование ответа на запрос
-	return StopInfo{ stop_ptr->name, vector<string_view>(buses_on_stop_set.begin(), buses_on_stop_set.end()) };
+	// Формирование ответа на запрос (без копирования списка маршрутов)
+	return StopInfo{ stops_[*stop_id].name, buses_on_stop_[*stop_id] };
 }
 
 // Функция получения информации о маршруте
@@ -116,40 +616,129 @@ optional<BusInfo> TransportCatalogue::GetBusInfo(string_view name) const {
 	using namespace detail;
 
 	// Если маршрут не найден
-	if (!busname_to_bus_.count(name)) {
+	const auto bus_id = FindBusId(name);
+	if (!bus_id) {
 		return nullopt;
 	}
 
-	// Ссылка на маршрут в базе данных
-	const Bus& bus_ref = *busname_to_bus_.at(name);
+	// Если база заморожена, статистика маршрута уже посчитана
+	if (is_frozen_) {
+		return buses_info_[*bus_id];
+	}
 
-	// Вычисление географической и фактической длины маршрута
-	double length_geographic = 0;
-	double length_actual = 0;
+	return ComputeBusInfo(buses_[*bus_id], ComputePathLength(buses_[*bus_id]));
+}
 
-	for (size_t n = 0; n + 1 < bus_ref.stops.size(); ++n) {
-		length_geographic += ComputeDistance(bus_ref.stops[n]->coordinate, bus_ref.stops[n + 1]->coordinate);
+// Функция заморозки базы данных: однократный расчёт статистики всех маршрутов после заполнения базы
+void TransportCatalogue::Freeze() {
+	if (is_frozen_) return;
 
-		if (distances_.count({ bus_ref.stops[n],  bus_ref.stops[n + 1] })) {
-			length_actual += distances_.at({ bus_ref.stops[n], bus_ref.stops[n + 1] });
+	// Все упомянутые в маршрутах и расстояниях остановки должны быть добавлены
+	for (StopId id = 0; id < stops_.size(); ++id) {
+		if (stops_state_[id] == StopState::Referenced) {
+			throw invalid_argument("Stop \""s + string(stops_[id].name) + "\" is referenced but not defined"s);
 		}
-		else {
-			length_actual += distances_.at({ bus_ref.stops[n + 1], bus_ref.stops[n] });
+	}
+
+	distances_.Build(stops_.size());
+
+	// Синус и косинус широты каждой остановки считаются один раз, а длины маршрутов - пакетно
+	geo::CoordinatesTable coordinates;
+	coordinates.Reserve(stops_.size());
+
+	for (const Stop& stop : stops_) {
+		coordinates.Add(stop.coordinate);
+	}
+
+	buses_info_.clear();
+	buses_info_.reserve(buses_.size());
+
+	for (const Bus& bus : buses_) {
+		buses_info_.push_back(ComputeBusInfo(bus, coordinates.ComputePathLength(bus.stops.data(), bus.stops.size())));
+	}
+
+	stopname_to_id_.Build();
+	busname_to_id_.Build();
+
+	is_frozen_ = true;
+}
+
+// Функция получения номера версии базы данных (увеличивается при каждом изменении базы, нужна для инвалидации кэшей)
+uint64_t TransportCatalogue::GetVersion() const {
+	return version_;
+}
+
+// Функция получения идентификатора добавленной остановки для изменения замороженной базы (иначе std::invalid_argument)
+StopId TransportCatalogue::GetDefinedStopId(string_view name) const {
+	const auto id = FindStopId(name);
+
+	if (!id || stops_state_[*id] != StopState::Defined) {
+		throw invalid_argument("Stop \""s + string(name) + "\" is not defined"s);
+	}
+
+	return *id;
+}
+
+// Функция проверки, что между соседними остановками маршрута заданы расстояния (иначе std::invalid_argument)
+void TransportCatalogue::CheckBusDistances(string_view name, const vector<StopId>& stops) const {
+	for (size_t n = 0; n + 1 < stops.size(); ++n) {
+		// Расстояние в одну сторону подставляется и в другую, поэтому достаточно проверить одно направление
+		if (!distances_.Get(stops[n], stops[n + 1])) {
+			throw invalid_argument("Bus \""s + string(name) + "\": distance between stops \""s + string(stops_[stops[n]].name)
+			                       + "\" and \""s + string(stops_[stops[n + 1]].name) + "\" is not set"s);
+		}
+	}
+}
+
+// Функция пересчёта статистики маршрутов, проходящих через остановку (для замороженной базы)
+void TransportCatalogue::UpdateBusesInfo(StopId stop) {
+	if (!is_frozen_) return;
+
+	// Название может остаться на остановке от повторно добавленного и затем удалённого маршрута
+	for (string_view bus_name : buses_on_stop_[stop]) {
+		if (const auto id = FindBusId(bus_name)) {
+			buses_info_[*id] = ComputeBusInfo(buses_[*id], ComputePathLength(buses_[*id]));
 		}
 	}
+}
+
+// Функция сброса заморозки базы данных (вызывается при любом изменении базы)
+void TransportCatalogue::Unfreeze() {
+	++version_;
+
+	if (!is_frozen_) return;
+
+	buses_info_.clear();
+	is_frozen_ = false;
+}
+
+// Функция расчёта географической длины маршрута в одну сторону (по одному расстоянию за вызов, для незамороженной базы)
+double TransportCatalogue::ComputePathLength(const Bus& bus) const {
+	double length = 0;
+
+	for (size_t n = 0; n + 1 < bus.stops.size(); ++n) {
+		length += geo::ComputeDistance(stops_[bus.stops[n]].coordinate, stops_[bus.stops[n + 1]].coordinate);
+	}
+
+	return length;
+}
+
+// Функция расчёта статистики маршрута (длина, извилистость, число остановок) по его географической длине в одну сторону
+BusInfo TransportCatalogue::ComputeBusInfo(const Bus& bus_ref, double path_length) const {
+	// Вычисление географической и фактической длины маршрута
+	double length_geographic = path_length;
+	double length_actual = 0;
+
+	for (size_t n = 0; n + 1 < bus_ref.stops.size(); ++n) {
+		length_actual += distances_.Get(bus_ref.stops[n], bus_ref.stops[n + 1]).value();
+	}
 
 	// Если маршрут линейный, нужно посчитать и обратный путь
 	if(bus_ref.type == BusRouteType::Line) {
 		length_geographic *= 2;
-		
-		for (size_t n = 0; n + 1 < bus_ref.stops.size(); ++n) {
 
-			if (distances_.count({ bus_ref.stops[n + 1],  bus_ref.stops[n] })) {
-				length_actual += distances_.at({ bus_ref.stops[n + 1], bus_ref.stops[n] });
-			}
-			else {
-				length_actual += distances_.at({ bus_ref.stops[n], bus_ref.stops[n + 1] });
-			}
+		for (size_t n = 0; n + 1 < bus_ref.stops.size(); ++n) {
+			length_actual += distances_.Get(bus_ref.stops[n + 1], bus_ref.stops[n]).value();
 		}
 	}
 
@@ -157,11 +746,7 @@ optional<BusInfo> TransportCatalogue::GetBusInfo(string_view name) const {
 	const double curvature = length_actual / length_geographic;
 
 	// Вычисление количества остановок и уникальных остановок маршрута
-	set<string_view> unique_stops;
-
-	for (const Stop* stop : bus_ref.stops) {
-		unique_stops.insert(stop->name);
-	}
+	set<StopId> unique_stops(bus_ref.stops.begin(), bus_ref.stops.end());
 
 	const size_t stops_num = (bus_ref.type == BusRouteType::Line && bus_ref.stops.size() != 0) ? 2 * bus_ref.stops.size() - 1 : bus_ref.stops.size();
 	const size_t unique_stops_num = unique_stops.size();
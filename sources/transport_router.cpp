@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include "transport_router.h"
+using namespace std;
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для функционала, связанного с построением маршрутов поездок
+namespace transport_router {
+
+// Пространство имён для структур и функций, использующихся только для внутренней работы transport_catalogue::transport_router
+namespace detail {
+
+// Рабочие массивы алгоритма Дейкстры. Чтобы не очищать массивы размером с граф перед каждым запросом,
+// вершина считается достигнутой в текущем запросе, только если её метка совпадает с номером запроса
+struct Workspace {
+    vector<double>   times;     // Лучшее найденное время до вершины
+    vector<StopId>   prev_stop; // Предыдущая вершина на лучшем пути
+    vector<uint32_t> prev_edge; // Ребро, по которому пришли в вершину на лучшем пути
+    vector<uint32_t> stamps;    // Номер запроса, в котором вершина была достигнута
+
+    uint32_t generation = 0; // Номер текущего запроса
+
+    vector<pair<double, StopId>> heap; // Очередь вершин с приоритетом по времени
+    vector<pair<StopId, uint32_t>> path; // Рёбра найденного пути (от конца к началу)
+
+    // Функция подготовки рабочих массивов к очередному запросу
+    void Prepare(size_t vertex_count) {
+        if (stamps.size() < vertex_count) {
+            times.resize(vertex_count);
+            prev_stop.resize(vertex_count);
+            prev_edge.resize(vertex_count);
+            stamps.resize(vertex_count, 0u);
+        }
+
+        // При переполнении номера запроса метки приходится сбросить
+        if (++generation == 0) {
+            fill(stamps.begin(), stamps.end(), 0u);
+            generation = 1;
+        }
+
+        heap.clear();
+        path.clear();
+    }
+
+    bool IsReached(StopId stop) const {
+        return stamps[stop] == generation;
+    }
+};
+
+// Функция получения рабочих массивов текущего потока
+Workspace& GetWorkspace() {
+    thread_local Workspace workspace;
+    return workspace;
+}
+
+}
+
+TransportRouter::TransportRouter(const TransportCatalogue& catalogue, const RoutingSettings& settings) : catalogue_(catalogue),
+                                                                                                      settings_(settings) {
+    const auto& buses = catalogue_.GetBuses();
+
+    // Рёбра графа вместе с остановкой, из которой они выходят
+    vector<pair<StopId, Edge>> edges;
+
+    for (BusId bus_id = 0; bus_id < buses.size(); ++bus_id) {
+        const Bus& bus = buses[bus_id];
+
+        // Если маршрут с тем же названием добавлялся повторно, действует последний
+        if (catalogue_.FindBusId(bus.name) != bus_id) continue;
+
+        AddBusEdges(edges, bus_id, bus.stops, false);
+
+        // По линейному маршруту автобус едет и в обратную сторону
+        if (bus.type == BusRouteType::Line) {
+            AddBusEdges(edges, bus_id, bus.stops, true);
+        }
+    }
+
+    ranges_.resize(catalogue_.GetStops().size());
+
+    AppendEdges(edges);
+}
+
+// Функция пересчёта рёбер, выходящих из остановок stops (после изменения проходящих через них маршрутов
+// или расстояний между остановками этих маршрутов). Новые остановки справочника добавляются в граф
+void TransportRouter::Update(vector<StopId> stops) {
+    ranges_.resize(catalogue_.GetStops().size());
+
+    sort(stops.begin(), stops.end());
+    stops.erase(unique(stops.begin(), stops.end()), stops.end());
+
+    vector<pair<StopId, Edge>> edges;
+
+    for (StopId stop : stops) {
+        // Прежний участок рёбер остановки больше не используется
+        stale_edges_ += ranges_[stop].end - ranges_[stop].begin;
+        ranges_[stop] = EdgesRange{};
+
+        // Рёбра из остановки дают только проходящие через неё маршруты (у удалённой остановки их нет)
+        if (catalogue_.IsStopRemoved(stop)) continue;
+
+        const auto stop_info = catalogue_.GetStopInfo(catalogue_.GetStop(stop).name);
+        if (!stop_info) continue;
+
+        for (string_view bus_name : stop_info->buses) {
+            const auto bus_id = catalogue_.FindBusId(bus_name);
+            if (!bus_id) continue;
+
+            const Bus& bus = catalogue_.GetBus(*bus_id);
+
+            AddBusEdges(edges, *bus_id, bus.stops, false, stop);
+
+            if (bus.type == BusRouteType::Line) {
+                AddBusEdges(edges, *bus_id, bus.stops, true, stop);
+            }
+        }
+    }
+
+    AppendEdges(edges);
+    CompactIfNeeded();
+}
+
+// Функция замены рёбер графа отсортированными рёбрами edges: из параллельных остаётся самое быстрое,
+// а участки остановок из edges дописываются в конец edges_
+void TransportRouter::AppendEdges(vector<pair<StopId, Edge>>& edges) {
+    // Из параллельных рёбер для поиска кратчайшего пути нужно только самое быстрое
+    sort(edges.begin(), edges.end(), [](const auto& lhs, const auto& rhs) {
+        return tie(lhs.first, lhs.second.to, lhs.second.weight, lhs.second.span_count, lhs.second.bus)
+             < tie(rhs.first, rhs.second.to, rhs.second.weight, rhs.second.span_count, rhs.second.bus);
+    });
+
+    edges.erase(unique(edges.begin(), edges.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first == rhs.first && lhs.second.to == rhs.second.to;
+    }), edges.end());
+
+    // Рёбра одной остановки идут подряд и образуют её новый участок
+    edges_.reserve(edges_.size() + edges.size());
+
+    for (const auto& [from, edge] : edges) {
+        if (ranges_[from].begin == ranges_[from].end) {
+            ranges_[from].begin = ranges_[from].end = static_cast<uint32_t>(edges_.size());
+        }
+
+        edges_.push_back(edge);
+        ++ranges_[from].end;
+    }
+}
+
+// Функция перестроения edges_ без устаревших участков, если их накопилось слишком много
+void TransportRouter::CompactIfNeeded() {
+    if (stale_edges_ <= max<size_t>(1024u, (edges_.size() - stale_edges_) / 8u)) return;
+
+    vector<Edge> edges;
+    edges.reserve(edges_.size() - stale_edges_);
+
+    for (EdgesRange& range : ranges_) {
+        const uint32_t begin = static_cast<uint32_t>(edges.size());
+        edges.insert(edges.end(), edges_.begin() + range.begin, edges_.begin() + range.end);
+        range = EdgesRange{ begin, static_cast<uint32_t>(edges.size()) };
+    }
+
+    edges_ = move(edges);
+    stale_edges_ = 0;
+}
+
+// Функция добавления в граф рёбер для последовательности остановок, проезжаемых автобусом в одном направлении
+// (если задана остановка only_from - только рёбер из неё)
+void TransportRouter::AddBusEdges(vector<pair<StopId, Edge>>& edges, BusId bus, const vector<StopId>& stops, bool reversed,
+                                  optional<StopId> only_from) const {
+    // Скорость в метрах в минуту
+    const double velocity = settings_.bus_velocity * 1000.0 / 60.0;
+
+    const size_t count = stops.size();
+    auto stop_at = [&stops, count, reversed](size_t n) { return reversed ? stops[count - 1 - n] : stops[n]; };
+
+    for (size_t i = 0; i < count; ++i) {
+        if (only_from && stop_at(i) != *only_from) continue;
+
+        double distance = 0.0;
+
+        for (size_t j = i + 1; j < count; ++j) {
+            distance += catalogue_.GetDistance(stop_at(j - 1), stop_at(j)).value();
+
+            // Поездка из остановки в неё же (по кольцу) не нужна для поиска маршрута
+            if (stop_at(i) == stop_at(j)) continue;
+
+            const double ride_time = distance / velocity;
+            edges.push_back({ stop_at(i), Edge{ stop_at(j), bus, static_cast<uint32_t>(j - i), settings_.bus_wait_time + ride_time, ride_time } });
+        }
+    }
+}
+
+// Функция построения маршрута поездки между остановками. Результат записывается в route
+// (его память переиспользуется), возвращается false, если маршрута не существует
+bool TransportRouter::BuildRoute(StopId from, StopId to, RouteInfo& route) const {
+    using namespace detail;
+
+    route.total_time = 0.0;
+    route.items.clear();
+
+    const size_t vertex_count = ranges_.size();
+    if (from >= vertex_count || to >= vertex_count) return false;
+
+    Workspace& ws = GetWorkspace();
+    ws.Prepare(vertex_count);
+
+    ws.times[from] = 0.0;
+    ws.stamps[from] = ws.generation;
+    ws.heap.push_back({ 0.0, from });
+
+    // Алгоритм Дейкстры с остановкой при извлечении целевой вершины
+    while (!ws.heap.empty()) {
+        pop_heap(ws.heap.begin(), ws.heap.end(), greater<>{});
+        const auto [time, stop] = ws.heap.back();
+        ws.heap.pop_back();
+
+        // Устаревшая запись в очереди
+        if (time > ws.times[stop]) continue;
+
+        if (stop == to) break;
+
+        for (uint32_t e = ranges_[stop].begin; e < ranges_[stop].end; ++e) {
+            const Edge& edge = edges_[e];
+            const double new_time = time + edge.weight;
+
+            if (!ws.IsReached(edge.to) || new_time < ws.times[edge.to]) {
+                ws.times[edge.to]     = new_time;
+                ws.prev_stop[edge.to] = stop;
+                ws.prev_edge[edge.to] = e;
+                ws.stamps[edge.to]    = ws.generation;
+
+                ws.heap.push_back({ new_time, edge.to });
+                push_heap(ws.heap.begin(), ws.heap.end(), greater<>{});
+            }
+        }
+    }
+
+    if (!ws.IsReached(to)) return false;
+
+    // Восстанавливаем путь от конца к началу
+    for (StopId stop = to; stop != from; stop = ws.prev_stop[stop]) {
+        ws.path.push_back({ ws.prev_stop[stop], ws.prev_edge[stop] });
+    }
+
+    // Каждое ребро пути - это ожидание автобуса на остановке и поездка на нём
+    const double wait_time = settings_.bus_wait_time;
+
+    for (auto it = ws.path.rbegin(); it != ws.path.rend(); ++it) {
+        const Edge& edge = edges_[it->second];
+
+        route.items.push_back({ RouteItemType::Wait, catalogue_.GetStop(it->first).name, 0u, wait_time });
+        route.items.push_back({ RouteItemType::Bus,  catalogue_.GetBus(edge.bus).name, edge.span_count, edge.ride_time });
+    }
+
+    route.total_time = ws.times[to];
+
+    return true;
+}
+
+// Функция получения настроек маршрутизации
+const RoutingSettings& TransportRouter::GetSettings() const {
+    return settings_;
+}
+
+}
+
+}
\ No newline at end of file
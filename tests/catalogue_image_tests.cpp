@@ -0,0 +1,170 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include "test_framework.h"
+#include "test_catalogue.h"
+#include "catalogue_image.h"
+#include "catalogue_versions.h"
+#include "json_reader.h"
+using namespace std;
+using namespace transport_catalogue;
+using namespace transport_catalogue::tests;
+
+// Пространство имён для функций, использующихся только внутри тестов
+namespace {
+
+// Файлы базы данных и образа, которые создают тесты (в рабочей директории ctest)
+const string BASE_FILE      = "catalogue_image_tests.db"s;
+const string IMAGE_FILE     = "catalogue_image_tests.img"s;
+const string BAD_IMAGE_FILE = "catalogue_image_tests_bad.img"s;
+
+// Функция получения конфигурации синтетического города
+bench::CityConfig MakeCityConfig(uint64_t seed) {
+    bench::CityConfig config;
+    config.seed          = seed;
+    config.stops_count   = 400;
+    config.buses_count   = 60;
+    config.stops_per_bus = 12;
+    return config;
+}
+
+// Функция заполнения справочника синтетическим городом и сохранения базы вместе с образом
+void FillAndSave(const bench::City& city, Catalogue& result) {
+    FillFromCity(city, result);
+    result.handler.SaveBase({ BASE_FILE, IMAGE_FILE }, {});
+}
+
+// Тест образа базы данных: MappedCatalogue отвечает на запросы так же, как справочник, по которому образ сохранён
+void TestImageMatchesCatalogue() {
+    for (uint64_t seed = 1; seed <= 3; ++seed) {
+        const bench::City city(MakeCityConfig(seed));
+
+        Catalogue original;
+        FillAndSave(city, original);
+
+        const catalogue_image::MappedCatalogue image(IMAGE_FILE);
+
+        const TransportCatalogue& catalogue = original.catalogue;
+
+        ASSERT_EQUAL(image.GetStopsCount(), catalogue.GetStops().size());
+        ASSERT_EQUAL(image.GetBusesCount(), catalogue.GetBuses().size());
+
+        for (const string& name : city.GetStopQueries()) {
+            const auto expected = original.handler.GetStopInfo(name);
+            const auto actual   = image.GetStopInfo(name);
+
+            ASSERT_EQUAL_HINT(actual.has_value(), expected.has_value(), name);
+            if (!expected) continue;
+
+            ASSERT_EQUAL_HINT(actual->name, expected->name, name);
+            ASSERT_HINT(vector<string_view>(actual->buses.begin(), actual->buses.end())
+                        == vector<string_view>(expected->buses.begin(), expected->buses.end()), name);
+        }
+
+        for (const string& name : city.GetBusQueries()) {
+            const auto expected = original.handler.GetBusInfo(name);
+            const auto actual   = image.GetBusInfo(name);
+
+            ASSERT_EQUAL_HINT(actual.has_value(), expected.has_value(), name);
+            if (!expected) continue;
+
+            ASSERT_EQUAL_HINT(actual->name,                expected->name,                name);
+            ASSERT_EQUAL_HINT(actual->stops_number,        expected->stops_number,        name);
+            ASSERT_EQUAL_HINT(actual->unique_stops_number, expected->unique_stops_number, name);
+            ASSERT_EQUAL_HINT(actual->route_length,        expected->route_length,        name);
+            ASSERT_EQUAL_HINT(actual->curvature,           expected->curvature,           name);
+        }
+
+        // Номера остановок в образе другие, поэтому расстояния сравниваются по названиям
+        const auto& stops = catalogue.GetStops();
+
+        for (StopId from = 0; from < stops.size(); ++from) {
+            for (StopId to = 0; to < stops.size(); to += 7) {
+                const auto image_from = image.FindStopId(stops[from].name);
+                const auto image_to   = image.FindStopId(stops[to].name);
+                ASSERT(image_from && image_to);
+
+                const string hint = string(stops[from].name) + " -> "s + string(stops[to].name);
+                ASSERT_HINT(image.GetDistance(*image_from, *image_to) == catalogue.GetDistance(from, to), hint);
+            }
+        }
+    }
+}
+
+// Функция обработки пакета запросов обработчиком пакетов (ответ - одна строка)
+string ProcessBatch(const json_reader::BatchProcessor& processor, const string& batch) {
+    istringstream input(batch);
+    ostringstream output;
+    processor.Process(input, output);
+    return output.str();
+}
+
+// Тест обработчика пакетов: по образу ответы на Stop и Bus совпадают с ответами по загруженной базе,
+// а на запросы, для которых в образе нет данных, выводится ошибка
+void TestBatchProcessorOverImage() {
+    const bench::City city(MakeCityConfig(4));
+
+    Catalogue original;
+    FillAndSave(city, original);
+
+    ostringstream batch;
+    batch << "{\"stat_requests\": ["sv;
+
+    for (size_t i = 0; i < 200; ++i) {
+        batch << (i ? ", "sv : ""sv) << "{\"id\": "sv << 2 * i + 1 << ", \"type\": \"Stop\", \"name\": \""sv << city.GetStopQueries()[i] << "\"}"sv;
+        batch << ", {\"id\": "sv << 2 * i + 2 << ", \"type\": \"Bus\", \"name\": \""sv << city.GetBusQueries()[i] << "\"}"sv;
+    }
+    batch << "]}\n"sv;
+
+    const catalogue_image::MappedCatalogue image(IMAGE_FILE);
+    const versioning::VersionedCatalogue versions(versioning::LoadSnapshot({ BASE_FILE, ""s }));
+
+    const string expected = ProcessBatch(json_reader::BatchProcessor(versions), batch.str());
+    const string actual   = ProcessBatch(json_reader::BatchProcessor(image), batch.str());
+
+    ASSERT(expected.find("\"buses\""sv) != string::npos && expected.find("\"route_length\""sv) != string::npos);
+    ASSERT_EQUAL(actual, expected);
+
+    const string route = ProcessBatch(json_reader::BatchProcessor(image),
+                                      "{\"stat_requests\": [{\"id\": 1, \"type\": \"Route\", \"from\": \"Stop 1\", \"to\": \"Stop 2\"}]}\n"s);
+    ASSERT_EQUAL(route, "[{\"error_message\":\"not supported\",\"request_id\":1}]\n"s);
+}
+
+// Тест открытия повреждённого образа: ошибка формата, а не чтение за границей отображения
+void TestTruncatedImage() {
+    const bench::City city(MakeCityConfig(5));
+
+    Catalogue original;
+    FillAndSave(city, original);
+
+    string data;
+    {
+        ifstream input(IMAGE_FILE, ios::binary);
+        data.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    }
+
+    for (size_t size : { size_t{ 16 }, data.size() / 2, data.size() - 1 }) {
+        ofstream(BAD_IMAGE_FILE, ios::binary).write(data.data(), static_cast<streamsize>(size));
+
+        bool thrown = false;
+        try {
+            const catalogue_image::MappedCatalogue image(BAD_IMAGE_FILE);
+        }
+        catch (const catalogue_image::ImageError&) {
+            thrown = true;
+        }
+
+        ASSERT_HINT(thrown, to_string(size) + " bytes"s);
+    }
+}
+
+}
+
+int main() {
+    RUN_TEST(TestImageMatchesCatalogue);
+    RUN_TEST(TestBatchProcessorOverImage);
+    RUN_TEST(TestTruncatedImage);
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include "test_framework.h"
+#include "geo.h"
+using namespace std;
+
+// Пространство имён для функций, использующихся только внутри тестов
+namespace {
+
+// Функция проверки, что результат пакетного расчёта совпадает с ComputeDistance
+// (с точностью до погрешности FMA, см. комментарий к CoordinatesTable)
+bool IsSameDistance(double actual, double expected) {
+    return abs(actual - expected) <= 1e-9 * max(1.0, expected);
+}
+
+// Функция получения случайных точек: большая часть - в пределах города, остальные - по всему земному шару
+// (в том числе совпадающие и почти противоположные, где acos наиболее чувствителен к погрешности)
+vector<geo::Coordinate> MakeCoordinates(mt19937_64& random, size_t count) {
+    uniform_real_distribution<double> city_lat(55.55, 55.90);
+    uniform_real_distribution<double> city_lng(37.35, 37.85);
+    uniform_real_distribution<double> world_lat(-90.0, 90.0);
+    uniform_real_distribution<double> world_lng(-180.0, 180.0);
+
+    vector<geo::Coordinate> coordinates;
+    coordinates.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 4 == 3) coordinates.push_back({ world_lat(random), world_lng(random) });
+        else            coordinates.push_back({ city_lat(random), city_lng(random) });
+    }
+
+    coordinates.push_back(coordinates.front());
+    coordinates.push_back({ -coordinates.front().lat, coordinates.front().lng + 180.0 });
+
+    return coordinates;
+}
+
+// Тест пакетного расчёта расстояний на 200000 случайных пар точек
+void TestComputeDistancesMatchesScalar() {
+    mt19937_64 random(18);
+
+    const vector<geo::Coordinate> coordinates = MakeCoordinates(random, 5000);
+
+    geo::CoordinatesTable table;
+    table.Reserve(coordinates.size());
+    for (const geo::Coordinate& coordinate : coordinates) table.Add(coordinate);
+
+    ASSERT_EQUAL(table.GetSize(), coordinates.size());
+
+    constexpr size_t pairs_count = 200000;
+    uniform_int_distribution<uint32_t> index(0, static_cast<uint32_t>(coordinates.size() - 1));
+
+    vector<uint32_t> from(pairs_count);
+    vector<uint32_t> to(pairs_count);
+    for (size_t i = 0; i < pairs_count; ++i) {
+        from[i] = index(random);
+        to[i]   = index(random);
+    }
+
+    // Совпадающие и противоположные точки
+    from[0] = 0;
+    to[0]   = static_cast<uint32_t>(coordinates.size() - 2);
+    from[1] = 0;
+    to[1]   = static_cast<uint32_t>(coordinates.size() - 1);
+
+    vector<double> result(pairs_count);
+    table.ComputeDistances(from.data(), to.data(), pairs_count, result.data());
+
+    for (size_t i = 0; i < pairs_count; ++i) {
+        const double expected = geo::ComputeDistance(coordinates[from[i]], coordinates[to[i]]);
+        ASSERT_HINT(IsSameDistance(result[i], expected), "pair "s + to_string(i));
+    }
+}
+
+// Тест длины ломаной: она равна сумме расстояний между соседними точками
+void TestComputePathLengthMatchesScalar() {
+    mt19937_64 random(180);
+
+    const vector<geo::Coordinate> coordinates = MakeCoordinates(random, 1000);
+
+    geo::CoordinatesTable table;
+    for (const geo::Coordinate& coordinate : coordinates) table.Add(coordinate);
+
+    uniform_int_distribution<uint32_t> index(0, static_cast<uint32_t>(coordinates.size() - 1));
+
+    for (size_t length : { 1u, 2u, 3u, 7u, 100u, 1001u }) {
+        vector<uint32_t> path(length);
+        for (uint32_t& point : path) point = index(random);
+
+        double expected = 0.0;
+        for (size_t i = 1; i < length; ++i) {
+            expected += geo::ComputeDistance(coordinates[path[i - 1]], coordinates[path[i]]);
+        }
+
+        ASSERT_HINT(IsSameDistance(table.ComputePathLength(path.data(), length), expected), to_string(length) + " points"s);
+    }
+}
+
+}
+
+int main() {
+    RUN_TEST(TestComputeDistancesMatchesScalar);
+    RUN_TEST(TestComputePathLengthMatchesScalar);
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <random>
+#include <optional>
+#include "test_framework.h"
+#include "name_index.h"
+using namespace std;
+using namespace transport_catalogue;
+
+// Пространство имён для функций, использующихся только внутри тестов
+namespace {
+
+// Класс проверки индекса: каждая операция выполняется и над индексом, и над хеш-таблицей, результаты сравниваются
+class IndexChecker {
+public:
+    void Set(string_view name, uint32_t id) {
+        index_.Set(name, id);
+        expected_[name] = id;
+    }
+
+    void Erase(string_view name) {
+        ASSERT_EQUAL_HINT(index_.Erase(name), expected_.erase(name) > 0, string(name));
+    }
+
+    void Build() {
+        index_.Build();
+    }
+
+    // Функция проверки поиска названия
+    void Check(string_view name) const {
+        const optional<uint32_t> actual = index_.Find(name);
+        const auto it = expected_.find(name);
+
+        ASSERT_EQUAL_HINT(actual.has_value(), it != expected_.end(), string(name));
+        if (actual) ASSERT_EQUAL_HINT(*actual, it->second, string(name));
+    }
+
+    // Функция проверки поиска всех названий из names
+    void CheckAll(const deque<string>& names) const {
+        for (const string& name : names) Check(name);
+    }
+
+private:
+    NameIndex index_;
+    unordered_map<string_view, uint32_t> expected_;
+};
+
+// Тест построенного индекса: все названия находятся, отсутствующие - нет (в том числе пустое и очень похожие)
+void TestBuiltIndexFindsAllNames() {
+    for (size_t count : { 0u, 1u, 2u, 3u, 10u, 1000u, 50000u }) {
+        deque<string> names;
+        for (size_t i = 0; i < count; ++i) names.push_back("Stop "s + to_string(i));
+
+        IndexChecker checker;
+        for (size_t i = 0; i < names.size(); ++i) checker.Set(names[i], static_cast<uint32_t>(i));
+
+        checker.CheckAll(names);
+        checker.Build();
+        checker.CheckAll(names);
+
+        deque<string> missing{ ""s, "Stop"s, "Stop "s, "stop 1"s, "Stop "s + to_string(count), "Stop 1 "s, string(1, '\0') };
+        checker.CheckAll(missing);
+    }
+}
+
+// Тест изменений после построения: изменение, удаление и повторное добавление названий, перестроение при накоплении
+// изменений и явное перестроение посреди изменений
+void TestRandomOperations() {
+    mt19937_64 random(25);
+
+    deque<string> names;
+    for (size_t i = 0; i < 20000; ++i) names.push_back("Name "s + to_string(random() % 1000000));
+
+    uniform_int_distribution<size_t> name_index(0, names.size() - 1);
+    uniform_int_distribution<int> operation(0, 99);
+
+    IndexChecker checker;
+    for (size_t i = 0; i < names.size() / 2; ++i) checker.Set(names[i], static_cast<uint32_t>(i));
+    checker.Build();
+
+    for (size_t step = 0; step < 200000; ++step) {
+        const string& name = names[name_index(random)];
+        const int op = operation(random);
+
+        if      (op < 30) checker.Set(name, static_cast<uint32_t>(step));
+        else if (op < 50) checker.Erase(name);
+        else              checker.Check(name);
+
+        if (step % 20000 == 0) checker.Build();
+    }
+
+    checker.CheckAll(names);
+    checker.Build();
+    checker.CheckAll(names);
+}
+
+}
+
+int main() {
+    RUN_TEST(TestBuiltIndexFindsAllNames);
+    RUN_TEST(TestRandomOperations);
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <stdexcept>
+#include "test_framework.h"
+#include "test_catalogue.h"
+#include "serialization.h"
+using namespace std;
+using namespace transport_catalogue;
+using namespace transport_catalogue::tests;
+
+// Пространство имён для функций, использующихся только внутри тестов
+namespace {
+
+// Файл базы данных, который создают тесты (в рабочей директории ctest)
+const string BASE_FILE = "serialization_tests.db"s;
+
+// Функция получения настроек отрисовки карты со всеми видами цветов
+map_renderer::RenderSettings MakeRenderSettings() {
+    map_renderer::RenderSettings settings;
+
+    settings.width                = 1200.0;
+    settings.height               = 800.0;
+    settings.padding              = 50.0;
+    settings.line_width           = 14.0;
+    settings.stop_radius          = 5.0;
+    settings.bus_label_font_size  = 20;
+    settings.bus_label_offset     = { 7.0, 15.0 };
+    settings.stop_label_font_size = 18;
+    settings.stop_label_offset    = { 7.0, -3.0 };
+    settings.underlayer_color     = map_renderer::Rgba(255, 255, 255, 0.85);
+    settings.underlayer_width     = 3.0;
+    settings.color_palette        = { "green"s, map_renderer::Rgb(255, 160, 0), "red"s };
+
+    return settings;
+}
+
+// Функция проверки, что два справочника отвечают на запросы одинаково (названия берутся из синтетического города)
+void CheckSameAnswers(const bench::City& city, const Catalogue& expected, const Catalogue& actual) {
+    const vector<string>& stop_queries = city.GetStopQueries();
+    const vector<string>& bus_queries  = city.GetBusQueries();
+
+    ASSERT_EQUAL(actual.catalogue.GetStops().size(), expected.catalogue.GetStops().size());
+    ASSERT_EQUAL(actual.catalogue.GetRoadDistances().size(), expected.catalogue.GetRoadDistances().size());
+
+    for (const string& name : stop_queries) {
+        const auto expected_info = expected.handler.GetStopInfo(name);
+        const auto actual_info   = actual.handler.GetStopInfo(name);
+
+        ASSERT_EQUAL_HINT(actual_info.has_value(), expected_info.has_value(), name);
+        if (!expected_info) continue;
+
+        ASSERT_HINT(vector<string_view>(actual_info->buses.begin(), actual_info->buses.end())
+                    == vector<string_view>(expected_info->buses.begin(), expected_info->buses.end()), name);
+
+        const geo::Coordinate expected_coordinate = expected.catalogue.GetStop(*expected.catalogue.FindStopId(name)).coordinate;
+        const geo::Coordinate actual_coordinate   = actual.catalogue.GetStop(*actual.catalogue.FindStopId(name)).coordinate;
+        ASSERT_HINT(actual_coordinate == expected_coordinate, name);
+    }
+
+    for (const string& name : bus_queries) {
+        const auto expected_info = expected.handler.GetBusInfo(name);
+        const auto actual_info   = actual.handler.GetBusInfo(name);
+
+        ASSERT_EQUAL_HINT(actual_info.has_value(), expected_info.has_value(), name);
+        if (!expected_info) continue;
+
+        ASSERT_EQUAL_HINT(actual_info->stops_number,        expected_info->stops_number,        name);
+        ASSERT_EQUAL_HINT(actual_info->unique_stops_number, expected_info->unique_stops_number, name);
+        ASSERT_EQUAL_HINT(actual_info->route_length,        expected_info->route_length,        name);
+        ASSERT_EQUAL_HINT(actual_info->curvature,           expected_info->curvature,           name);
+    }
+
+    RouteInfo expected_route;
+    RouteInfo actual_route;
+
+    for (size_t i = 0; i + 1 < stop_queries.size(); i += 2) {
+        const string hint = stop_queries[i] + " -> "s + stop_queries[i + 1];
+
+        const bool expected_found = expected.handler.BuildRoute(stop_queries[i], stop_queries[i + 1], expected_route);
+        const bool actual_found   = actual.handler.BuildRoute(stop_queries[i], stop_queries[i + 1], actual_route);
+
+        ASSERT_EQUAL_HINT(actual_found, expected_found, hint);
+        ASSERT_EQUAL_HINT(actual_route.total_time, expected_route.total_time, hint);
+        ASSERT_EQUAL_HINT(actual_route.items.size(), expected_route.items.size(), hint);
+    }
+
+    const map_renderer::RenderSettings render_settings = MakeRenderSettings();
+
+    ostringstream expected_map;
+    ostringstream actual_map;
+    expected.handler.RenderMap(render_settings, expected_map);
+    actual.handler.RenderMap(render_settings, actual_map);
+
+    ASSERT(actual_map.str() == expected_map.str());
+}
+
+// Тест сохранения и загрузки базы данных: загруженная база отвечает на запросы так же, как исходная
+void TestRoundTrip() {
+    for (uint64_t seed = 1; seed <= 3; ++seed) {
+        bench::CityConfig config;
+        config.seed          = seed;
+        config.stops_count   = 300;
+        config.buses_count   = 40;
+        config.stops_per_bus = 12;
+
+        const bench::City city(config);
+        const transport_router::RoutingSettings routing_settings{ 4, 35.0 };
+
+        Catalogue original;
+        FillFromCity(city, original, routing_settings);
+
+        serialization::BaseSettings base_settings;
+        base_settings.render_settings  = MakeRenderSettings();
+        base_settings.routing_settings = routing_settings;
+
+        original.handler.SaveBase({ BASE_FILE, ""s }, base_settings);
+
+        Catalogue loaded;
+        const serialization::BaseSettings loaded_settings = loaded.handler.LoadBase({ BASE_FILE, ""s });
+
+        ASSERT(loaded_settings.render_settings == base_settings.render_settings);
+        ASSERT(loaded_settings.routing_settings.has_value());
+        ASSERT_EQUAL(loaded_settings.routing_settings->bus_wait_time, routing_settings.bus_wait_time);
+        ASSERT_EQUAL(loaded_settings.routing_settings->bus_velocity,  routing_settings.bus_velocity);
+
+        CheckSameAnswers(city, original, loaded);
+    }
+}
+
+// Тест загрузки базы данных в непустой справочник: загрузка отклоняется, а справочник не меняется
+void TestLoadIntoNonEmptyCatalogue() {
+    bench::CityConfig config;
+    config.stops_count = 50;
+    config.buses_count = 5;
+
+    const bench::City city(config);
+
+    Catalogue original;
+    FillFromCity(city, original, transport_router::RoutingSettings{ 6, 40.0 });
+    original.handler.SaveBase({ BASE_FILE, ""s }, { nullopt, transport_router::RoutingSettings{ 6, 40.0 } });
+
+    Catalogue loaded;
+    loaded.handler.LoadBase({ BASE_FILE, ""s });
+
+    bool thrown = false;
+    try {
+        loaded.handler.LoadBase({ BASE_FILE, ""s });
+    }
+    catch (const invalid_argument&) {
+        thrown = true;
+    }
+
+    ASSERT(thrown);
+    CheckSameAnswers(city, original, loaded);
+}
+
+// Тест загрузки обрезанного файла: ошибка формата, а не чтение за границей буфера
+void TestTruncatedFile() {
+    bench::CityConfig config;
+    config.stops_count = 50;
+    config.buses_count = 5;
+
+    const bench::City city(config);
+
+    Catalogue original;
+    FillFromCity(city, original, transport_router::RoutingSettings{ 6, 40.0 });
+    original.handler.SaveBase({ BASE_FILE, ""s }, { MakeRenderSettings(), transport_router::RoutingSettings{ 6, 40.0 } });
+
+    string data;
+    {
+        ifstream input(BASE_FILE, ios::binary);
+        data.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    }
+
+    for (size_t size : { size_t{ 0 }, size_t{ 4 }, data.size() / 3, data.size() / 2, data.size() - 1 }) {
+        TransportCatalogue catalogue;
+
+        bool thrown = false;
+        try {
+            serialization::LoadBase(string_view(data.data(), size), catalogue);
+        }
+        catch (const serialization::SerializationError&) {
+            thrown = true;
+        }
+
+        ASSERT_HINT(thrown, to_string(size) + " bytes"s);
+    }
+}
+
+}
+
+int main() {
+    RUN_TEST(TestRoundTrip);
+    RUN_TEST(TestLoadIntoNonEmptyCatalogue);
+    RUN_TEST(TestTruncatedFile);
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <optional>
+#include "city_generator.h"
+#include "transport_catalogue.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+
+// Общая заготовка для тестов: справочник вместе с отрисовщиком и обработчиком запросов
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для тестов транспортного справочника
+namespace tests {
+
+// Структура справочника вместе с отрисовщиком и обработчиком запросов
+struct Catalogue {
+    TransportCatalogue              catalogue;
+    map_renderer::MapRenderer       renderer{ catalogue };
+    request_handler::RequestHandler handler{ catalogue, renderer };
+};
+
+// Функция заполнения пустого справочника синтетическим городом (настройки маршрутизации задаются, если переданы)
+inline void FillFromCity(const bench::City& city, Catalogue& result,
+                         const std::optional<transport_router::RoutingSettings>& routing_settings = std::nullopt) {
+    std::vector<request_handler::AddStopRequest> add_stop_requests;
+    std::vector<request_handler::AddBusRequest>  add_bus_requests;
+    city.GetBaseRequests(add_stop_requests, add_bus_requests);
+
+    if (routing_settings) result.handler.SetRoutingSettings(*routing_settings);
+    result.handler.SetData(add_stop_requests, add_bus_requests);
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+// Минимальный набор проверок для тестов: при нарушении проверки выводится место и выражение,
+// и программа завершается с ненулевым кодом, поэтому ctest считает тест упавшим
+
+// Пространство имён транспортного справочника
+namespace transport_catalogue {
+
+// Пространство имён для тестов транспортного справочника
+namespace tests {
+
+// Функция проверки условия
+inline void AssertImpl(bool value, const std::string& expr_str, const std::string& file, const std::string& func, unsigned line,
+                       const std::string& hint) {
+    if (value) return;
+
+    std::cerr << file << "(" << line << "): " << func << ": ASSERT(" << expr_str << ") failed.";
+    if (!hint.empty()) std::cerr << " Hint: " << hint;
+    std::cerr << std::endl;
+
+    std::abort();
+}
+
+// Функция проверки равенства значений
+template <typename T, typename U>
+void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str, const std::string& file,
+                     const std::string& func, unsigned line, const std::string& hint) {
+    if (t == u) return;
+
+    std::cerr << file << "(" << line << "): " << func << ": ASSERT_EQUAL(" << t_str << ", " << u_str << ") failed: "
+              << t << " != " << u << ".";
+    if (!hint.empty()) std::cerr << " Hint: " << hint;
+    std::cerr << std::endl;
+
+    std::abort();
+}
+
+// Функция запуска теста
+template <typename TestFunc>
+void RunTestImpl(const TestFunc& func, const std::string& test_name) {
+    func();
+    std::cerr << test_name << " OK" << std::endl;
+}
+
+}
+
+}
+
+#define ASSERT(expr) transport_catalogue::tests::AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, std::string())
+
+#define ASSERT_HINT(expr, hint) transport_catalogue::tests::AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+#define ASSERT_EQUAL(a, b) transport_catalogue::tests::AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, std::string())
+
+#define ASSERT_EQUAL_HINT(a, b, hint) transport_catalogue::tests::AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+#define RUN_TEST(func) transport_catalogue::tests::RunTestImpl((func), #func)
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <queue>
+#include <limits>
+#include <cmath>
+#include <functional>
+#include "test_framework.h"
+#include "city_generator.h"
+#include "transport_catalogue.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+using namespace std;
+using namespace transport_catalogue;
+
+// Пространство имён для функций, использующихся только внутри тестов
+namespace {
+
+// Граф эталонного алгоритма: рёбра из каждой остановки (остановка назначения, время ожидания и поездки)
+using ReferenceGraph = vector<vector<pair<StopId, double>>>;
+
+// Функция построения графа прямо по маршрутам справочника (без отбора параллельных рёбер)
+ReferenceGraph BuildReferenceGraph(const TransportCatalogue& catalogue, const transport_router::RoutingSettings& settings) {
+    const double velocity = settings.bus_velocity * 1000.0 / 60.0;
+
+    ReferenceGraph graph(catalogue.GetStops().size());
+
+    auto add_edges = [&](const vector<StopId>& stops) {
+        for (size_t i = 0; i < stops.size(); ++i) {
+            double distance = 0.0;
+            for (size_t j = i + 1; j < stops.size(); ++j) {
+                distance += *catalogue.GetDistance(stops[j - 1], stops[j]);
+                if (stops[i] != stops[j]) graph[stops[i]].push_back({ stops[j], settings.bus_wait_time + distance / velocity });
+            }
+        }
+    };
+
+    const auto& buses = catalogue.GetBuses();
+    for (BusId bus_id = 0; bus_id < buses.size(); ++bus_id) {
+        if (catalogue.FindBusId(buses[bus_id].name) != bus_id) continue;
+
+        add_edges(buses[bus_id].stops);
+
+        if (buses[bus_id].type == BusRouteType::Line) {
+            add_edges(vector<StopId>(buses[bus_id].stops.rbegin(), buses[bus_id].stops.rend()));
+        }
+    }
+
+    return graph;
+}
+
+// Функция поиска кратчайшего времени поездки из остановки from до каждой остановки простым алгоритмом Дейкстры
+vector<double> ReferenceTimes(const ReferenceGraph& graph, StopId from) {
+    vector<double> times(graph.size(), numeric_limits<double>::infinity());
+    priority_queue<pair<double, StopId>, vector<pair<double, StopId>>, greater<>> queue;
+
+    times[from] = 0.0;
+    queue.push({ 0.0, from });
+
+    while (!queue.empty()) {
+        const auto [time, stop] = queue.top();
+        queue.pop();
+        if (time > times[stop]) continue;
+
+        for (const auto& [to, weight] : graph[stop]) {
+            if (time + weight < times[to]) {
+                times[to] = time + weight;
+                queue.push({ times[to], to });
+            }
+        }
+    }
+
+    return times;
+}
+
+// Функция проверки маршрутов между всеми парами остановок синтетического города по эталонному алгоритму
+void CheckCity(const bench::CityConfig& config, const transport_router::RoutingSettings& settings) {
+    const bench::City city(config);
+
+    vector<request_handler::AddStopRequest> add_stop_requests;
+    vector<request_handler::AddBusRequest>  add_bus_requests;
+    city.GetBaseRequests(add_stop_requests, add_bus_requests);
+
+    TransportCatalogue catalogue;
+    map_renderer::MapRenderer renderer(catalogue);
+    request_handler::RequestHandler handler(catalogue, renderer);
+
+    handler.SetRoutingSettings(settings);
+    handler.SetData(add_stop_requests, add_bus_requests);
+
+    const auto& stops = catalogue.GetStops();
+    const ReferenceGraph graph = BuildReferenceGraph(catalogue, settings);
+    RouteInfo route;
+
+    for (StopId from = 0; from < stops.size(); ++from) {
+        const vector<double> expected = ReferenceTimes(graph, from);
+
+        for (StopId to = 0; to < stops.size(); ++to) {
+            const string hint = string(stops[from].name) + " -> "s + string(stops[to].name);
+            const bool found = handler.BuildRoute(stops[from].name, stops[to].name, route);
+
+            ASSERT_EQUAL_HINT(found, !isinf(expected[to]), hint);
+            if (!found) continue;
+
+            ASSERT_HINT(abs(route.total_time - expected[to]) < 1e-6 * max(1.0, expected[to]), hint);
+
+            // Маршрут состоит из пар "ожидание - поездка", и их время в сумме равно общему
+            ASSERT_EQUAL_HINT(route.items.size() % 2, 0u, hint);
+
+            double total_time = 0.0;
+            for (size_t i = 0; i < route.items.size(); ++i) {
+                const RouteItem& item = route.items[i];
+                total_time += item.time;
+
+                if (i % 2 == 0) {
+                    ASSERT_HINT(item.type == RouteItemType::Wait, hint);
+                    ASSERT_EQUAL_HINT(item.time, static_cast<double>(settings.bus_wait_time), hint);
+                }
+                else {
+                    ASSERT_HINT(item.type == RouteItemType::Bus, hint);
+                    ASSERT_HINT(item.span_count > 0 && catalogue.FindBusId(item.name), hint);
+                }
+            }
+
+            ASSERT_HINT(abs(total_time - route.total_time) < 1e-6 * max(1.0, total_time), hint);
+        }
+    }
+}
+
+// Тест маршрутов в городе из линейных и кольцевых маршрутов
+void TestRoutesMatchReference() {
+    for (uint64_t seed = 1; seed <= 3; ++seed) {
+        bench::CityConfig config;
+        config.seed          = seed;
+        config.stops_count   = 150;
+        config.buses_count   = 25;
+        config.stops_per_bus = 10;
+
+        CheckCity(config, { 6, 40.0 });
+    }
+}
+
+// Тест маршрутов в городе, где часть остановок не связана маршрутами, а ожидание бесплатно
+void TestSparseCityRoutes() {
+    bench::CityConfig config;
+    config.seed          = 7;
+    config.stops_count   = 200;
+    config.buses_count   = 8;
+    config.stops_per_bus = 6;
+
+    CheckCity(config, { 0, 30.0 });
+}
+
+}
+
+int main() {
+    RUN_TEST(TestRoutesMatchReference);
+    RUN_TEST(TestSparseCityRoutes);
+}
\ No newline at end of file
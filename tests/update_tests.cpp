@@ -0,0 +1,420 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <stdexcept>
+#include "test_framework.h"
+#include "test_catalogue.h"
+using namespace std;
+using namespace transport_catalogue;
+using namespace transport_catalogue::tests;
+
+// Пространство имён для функций, использующихся только внутри тестов
+namespace {
+
+const transport_router::RoutingSettings ROUTING_SETTINGS{ 5, 36.0 };
+
+// Структура маршрута модели
+struct ModelBus {
+    BusRouteType   type;
+    vector<string> stops;
+};
+
+// Класс модели базы данных: то же содержимое, что у справочника, в простых контейнерах.
+// Изменения применяются к модели по тем же правилам, что и к справочнику, а затем справочник, заполненный
+// по модели с нуля, сравнивается со справочником, изменённым по частям
+class Model {
+public:
+    explicit Model(const bench::City& city) {
+        vector<request_handler::AddStopRequest> add_stop_requests;
+        vector<request_handler::AddBusRequest>  add_bus_requests;
+        city.GetBaseRequests(add_stop_requests, add_bus_requests);
+
+        for (const auto& request : add_stop_requests) {
+            stops_[string(request.name)] = request.coordinate;
+            for (const auto& [to, distance] : request.distances) {
+                distances_[{ string(request.name), string(to) }] = distance;
+            }
+        }
+
+        for (const auto& request : add_bus_requests) {
+            buses_[string(request.name)] = { request.type, vector<string>(request.stops.begin(), request.stops.end()) };
+        }
+    }
+
+    // Функция заполнения пустого справочника содержимым модели
+    void Fill(Catalogue& result) const {
+        vector<request_handler::AddStopRequest> add_stop_requests;
+        vector<request_handler::AddBusRequest>  add_bus_requests;
+
+        map<string_view, size_t> stop_index;
+        for (const auto& [name, coordinate] : stops_) {
+            stop_index[name] = add_stop_requests.size();
+            add_stop_requests.push_back({ name, coordinate, {} });
+        }
+
+        for (const auto& [stops, distance] : distances_) {
+            add_stop_requests[stop_index.at(stops.first)].distances.push_back({ stops.second, distance });
+        }
+
+        for (const auto& [name, bus] : buses_) {
+            add_bus_requests.push_back({ name, bus.type, vector<string_view>(bus.stops.begin(), bus.stops.end()) });
+        }
+
+        result.handler.SetRoutingSettings(ROUTING_SETTINGS);
+        result.handler.SetData(add_stop_requests, add_bus_requests);
+    }
+
+    const map<string, geo::Coordinate>& GetStops() const { return stops_; }
+    const map<string, ModelBus>&        GetBuses() const { return buses_; }
+    const map<pair<string, string>, int>& GetDistances() const { return distances_; }
+
+    bool HasDistance(const string& from, const string& to) const {
+        return distances_.count({ from, to }) > 0 || distances_.count({ to, from }) > 0;
+    }
+
+    // Функция проверки, что через остановку проходит хотя бы один маршрут
+    bool HasBuses(const string& stop) const {
+        for (const auto& [name, bus] : buses_) {
+            if (find(bus.stops.begin(), bus.stops.end(), stop) != bus.stops.end()) return true;
+        }
+        return false;
+    }
+
+    // Функция проверки, что расстояние нужно маршрутам (соседние остановки, между которыми нет другого расстояния)
+    bool IsDistanceUsed(const string& from, const string& to) const {
+        if (distances_.count({ to, from }) > 0) return false;
+
+        for (const auto& [name, bus] : buses_) {
+            for (size_t i = 0; i + 1 < bus.stops.size(); ++i) {
+                if ((bus.stops[i] == from && bus.stops[i + 1] == to) || (bus.stops[i] == to && bus.stops[i + 1] == from)) return true;
+            }
+        }
+        return false;
+    }
+
+    void UpdateStop(const string& name, geo::Coordinate coordinate) { stops_[name] = coordinate; }
+    void UpdateDistance(const string& from, const string& to, int distance) { distances_[{ from, to }] = distance; }
+    void RemoveDistance(const string& from, const string& to) { distances_.erase({ from, to }); }
+    void UpdateBus(const string& name, ModelBus bus) { buses_[name] = move(bus); }
+    void RemoveBus(const string& name) { buses_.erase(name); }
+
+    // Удаление остановки удаляет и расстояния от неё и до неё
+    void RemoveStop(const string& name) {
+        stops_.erase(name);
+        for (auto it = distances_.begin(); it != distances_.end(); ) {
+            if (it->first.first == name || it->first.second == name) it = distances_.erase(it);
+            else                                                     ++it;
+        }
+    }
+
+private:
+    map<string, geo::Coordinate>   stops_;
+    map<pair<string, string>, int> distances_;
+    map<string, ModelBus>          buses_;
+};
+
+// Класс генератора случайных пакетов изменений, не нарушающих целостность базы. Каждая группа изменений пакета
+// сразу применяется к модели, поэтому следующая группа генерируется уже по изменённой модели
+class BatchGenerator {
+public:
+    BatchGenerator(uint64_t seed, Model& model) : random_(seed), model_(model) { }
+
+    // Функция получения пакета изменений (названия хранятся в генераторе до следующего вызова)
+    request_handler::UpdateRequests Generate() {
+        names_.clear();
+        request_handler::UpdateRequests batch;
+
+        // Новые и перемещённые остановки вместе с расстояниями от них
+        for (size_t i = Below(4); i > 0; --i) {
+            const string& name = Chance(0.5) ? Store("New stop "s + to_string(next_stop_++)) : Store(PickStop());
+            const geo::Coordinate coordinate{ 55.55 + 0.35 * Uniform(), 37.35 + 0.50 * Uniform() };
+
+            request_handler::AddStopRequest request{ name, coordinate, {} };
+            model_.UpdateStop(name, coordinate);
+
+            for (size_t j = Below(3); j > 0; --j) {
+                const string& to = Store(PickStop());
+                const int distance = Distance();
+                request.distances.push_back({ to, distance });
+                model_.UpdateDistance(name, to, distance);
+            }
+
+            batch.update_stops.push_back(move(request));
+        }
+
+        // Отдельные расстояния
+        for (size_t i = Below(4); i > 0; --i) {
+            const string& from = Store(PickStop());
+            const string& to   = Store(PickStop());
+            const int distance = Distance();
+            batch.update_distances.push_back({ from, to, distance });
+            model_.UpdateDistance(from, to, distance);
+        }
+
+        // Маршруты для изменения выбираются заранее: для них нужны расстояния, которые задаются до изменения маршрутов
+        vector<pair<string_view, ModelBus>> new_buses;
+        for (size_t i = Below(4); i > 0; --i) {
+            const string& name = Chance(0.4) || model_.GetBuses().empty() ? Store("New bus "s + to_string(next_bus_++)) : Store(PickBus());
+
+            ModelBus bus{ Chance(0.5) ? BusRouteType::Circle : BusRouteType::Line, {} };
+            for (size_t j = 2 + Below(6); j > 0; --j) bus.stops.push_back(PickStop());
+            if (bus.type == BusRouteType::Circle) bus.stops.push_back(bus.stops.front());
+
+            for (size_t j = 0; j + 1 < bus.stops.size(); ++j) {
+                if (model_.HasDistance(bus.stops[j], bus.stops[j + 1])) continue;
+
+                const int distance = Distance();
+                batch.update_distances.push_back({ Store(bus.stops[j]), Store(bus.stops[j + 1]), distance });
+                model_.UpdateDistance(bus.stops[j], bus.stops[j + 1], distance);
+            }
+
+            new_buses.push_back({ name, move(bus) });
+        }
+
+        // Удаляемые маршруты
+        for (size_t i = Below(3); i > 0 && !model_.GetBuses().empty(); --i) {
+            const string& name = Store(PickBus());
+            batch.remove_buses.push_back(name);
+            model_.RemoveBus(name);
+        }
+
+        // Добавляемые и изменяемые маршруты
+        for (auto& [name, bus] : new_buses) {
+            batch.update_buses.push_back({ name, bus.type, vector<string_view>() });
+            for (const string& stop : bus.stops) batch.update_buses.back().stops.push_back(Store(stop));
+            model_.UpdateBus(string(name), move(bus));
+        }
+
+        // Удаляемые расстояния, которые не нужны маршрутам
+        for (size_t i = Below(4); i > 0; --i) {
+            auto it = model_.GetDistances().begin();
+            advance(it, Below(model_.GetDistances().size()));
+            const auto [from, to] = it->first;
+
+            if (model_.IsDistanceUsed(from, to)) continue;
+
+            batch.remove_distances.push_back({ Store(from), Store(to) });
+            model_.RemoveDistance(from, to);
+        }
+
+        // Удаляемые остановки, через которые не проходят маршруты
+        for (size_t i = Below(3); i > 0; --i) {
+            const string name = PickStop();
+            if (model_.HasBuses(name) || model_.GetStops().size() <= 2) continue;
+
+            batch.remove_stops.push_back(Store(name));
+            model_.RemoveStop(name);
+        }
+
+        return batch;
+    }
+
+    // Функция получения случайного числа из [0, count)
+    size_t Below(size_t count) {
+        return uniform_int_distribution<size_t>(0, count - 1)(random_);
+    }
+
+    // Функция получения случайной остановки модели
+    string PickStop() {
+        auto it = model_.GetStops().begin();
+        advance(it, Below(model_.GetStops().size()));
+        return it->first;
+    }
+
+private:
+    double Uniform() { return uniform_real_distribution<double>(0.0, 1.0)(random_); }
+    bool Chance(double p) { return Uniform() < p; }
+    int Distance() { return uniform_int_distribution<int>(100, 5000)(random_); }
+
+    string PickBus() {
+        auto it = model_.GetBuses().begin();
+        advance(it, Below(model_.GetBuses().size()));
+        return it->first;
+    }
+
+    // Функция сохранения названия на время жизни пакета
+    const string& Store(string name) {
+        names_.push_back(move(name));
+        return names_.back();
+    }
+
+    mt19937_64 random_;
+    Model&     model_;
+    size_t     next_stop_ = 0;
+    size_t     next_bus_  = 0;
+
+    deque<string> names_; // Названия, на которые ссылается последний пакет
+};
+
+// Функция проверки, что справочник, изменённый по частям, отвечает на запросы так же, как заполненный с нуля
+void CheckSameAnswers(const Model& model, const Catalogue& expected, const Catalogue& actual, mt19937_64& random) {
+    vector<string> stop_names;
+    for (const auto& [name, coordinate] : model.GetStops()) stop_names.push_back(name);
+    stop_names.push_back("Stop 0"s);
+    stop_names.push_back("No such stop"s);
+
+    for (const string& name : stop_names) {
+        const auto expected_info = expected.handler.GetStopInfo(name);
+        const auto actual_info   = actual.handler.GetStopInfo(name);
+
+        ASSERT_EQUAL_HINT(actual_info.has_value(), expected_info.has_value(), name);
+        if (!expected_info) continue;
+
+        ASSERT_HINT(vector<string_view>(actual_info->buses.begin(), actual_info->buses.end())
+                    == vector<string_view>(expected_info->buses.begin(), expected_info->buses.end()), name);
+    }
+
+    vector<string> bus_names;
+    for (const auto& [name, bus] : model.GetBuses()) bus_names.push_back(name);
+    bus_names.push_back("Bus 0"s);
+    bus_names.push_back("No such bus"s);
+
+    for (const string& name : bus_names) {
+        const auto expected_info = expected.handler.GetBusInfo(name);
+        const auto actual_info   = actual.handler.GetBusInfo(name);
+
+        ASSERT_EQUAL_HINT(actual_info.has_value(), expected_info.has_value(), name);
+        if (!expected_info) continue;
+
+        ASSERT_EQUAL_HINT(actual_info->stops_number,        expected_info->stops_number,        name);
+        ASSERT_EQUAL_HINT(actual_info->unique_stops_number, expected_info->unique_stops_number, name);
+        ASSERT_EQUAL_HINT(actual_info->route_length,        expected_info->route_length,        name);
+        ASSERT_HINT(abs(actual_info->curvature - expected_info->curvature) <= 1e-9 * abs(expected_info->curvature)
+                    || (isnan(actual_info->curvature) && isnan(expected_info->curvature)), name);
+    }
+
+    // Маршруты могут проходить по разным автобусам с одинаковым временем, поэтому сравнивается только время
+    RouteInfo expected_route;
+    RouteInfo actual_route;
+    uniform_int_distribution<size_t> stop_index(0, stop_names.size() - 1);
+
+    for (size_t i = 0; i < 300; ++i) {
+        const string& from = stop_names[stop_index(random)];
+        const string& to   = stop_names[stop_index(random)];
+        const string hint = from + " -> "s + to;
+
+        const bool expected_found = expected.handler.BuildRoute(from, to, expected_route);
+        const bool actual_found   = actual.handler.BuildRoute(from, to, actual_route);
+
+        ASSERT_EQUAL_HINT(actual_found, expected_found, hint);
+        ASSERT_HINT(abs(actual_route.total_time - expected_route.total_time) <= 1e-9 * max(1.0, expected_route.total_time), hint);
+    }
+
+    // Поиск остановок рядом с точками, в том числе с перемещёнными и новыми остановками
+    vector<NearbyStop> expected_stops;
+    vector<NearbyStop> actual_stops;
+
+    for (size_t i = 0; i < 20; ++i) {
+        const geo::Coordinate center = model.GetStops().at(stop_names[stop_index(random) % model.GetStops().size()]);
+        const double radius = 200.0 + 300.0 * static_cast<double>(i);
+
+        expected.handler.FindStopsNearby(center, radius, expected_stops);
+        actual.handler.FindStopsNearby(center, radius, actual_stops);
+
+        ASSERT_EQUAL(actual_stops.size(), expected_stops.size());
+        for (size_t j = 0; j < expected_stops.size(); ++j) {
+            ASSERT_EQUAL(actual_stops[j].name, expected_stops[j].name);
+        }
+    }
+}
+
+// Функция проверки справочника, изменённого по частям, по справочнику, заполненному по модели с нуля
+void CheckAgainstFreshBuild(const Model& model, const Catalogue& actual, mt19937_64& random) {
+    Catalogue expected;
+    model.Fill(expected);
+    CheckSameAnswers(model, expected, actual, random);
+}
+
+// Тест пакетов изменений: после каждого пакета справочник отвечает так же, как заполненный с нуля по итоговой базе.
+// Пакетов достаточно, чтобы пространственный индекс и граф маршрутов несколько раз перестраивались целиком
+void TestUpdatesMatchFreshBuild() {
+    for (uint64_t seed = 1; seed <= 3; ++seed) {
+        bench::CityConfig config;
+        config.seed          = seed;
+        config.stops_count   = 200;
+        config.buses_count   = 30;
+        config.stops_per_bus = 10;
+
+        const bench::City city(config);
+
+        Model model(city);
+        Catalogue actual;
+        model.Fill(actual);
+
+        BatchGenerator generator(seed * 1000, model);
+        mt19937_64 random(seed);
+
+        for (size_t round = 0; round < 60; ++round) {
+            actual.handler.UpdateData(generator.Generate());
+
+            if (round % 5 == 4) CheckAgainstFreshBuild(model, actual, random);
+        }
+    }
+}
+
+// Тест отката: пакет, в котором есть недопустимое изменение, не меняет базу, а справочник после отката
+// по-прежнему можно менять
+void TestFailedBatchIsRolledBack() {
+    bench::CityConfig config;
+    config.seed          = 11;
+    config.stops_count   = 150;
+    config.buses_count   = 25;
+    config.stops_per_bus = 8;
+
+    const bench::City city(config);
+
+    Model model(city);
+    Catalogue actual;
+    model.Fill(actual);
+
+    mt19937_64 random(11);
+
+    for (uint64_t seed = 1; seed <= 20; ++seed) {
+        // Пакет генерируется по копии модели: при откате модель остаётся прежней
+        Model changed = model;
+        BatchGenerator generator(seed, changed);
+        request_handler::UpdateRequests batch = generator.Generate();
+
+        // Недопустимое изменение в конце пакета: маршрут через несуществующую остановку или удаление остановки с маршрутами
+        string busy_stop;
+        if (seed % 2 == 0) {
+            batch.update_buses.push_back({ "Broken bus"sv, BusRouteType::Line, { "No such stop"sv } });
+        }
+        else {
+            do busy_stop = generator.PickStop(); while (!changed.HasBuses(busy_stop));
+            batch.remove_stops.push_back(busy_stop);
+        }
+
+        bool thrown = false;
+        try {
+            actual.handler.UpdateData(batch);
+        }
+        catch (const exception&) {
+            thrown = true;
+        }
+
+        ASSERT(thrown);
+        CheckAgainstFreshBuild(model, actual, random);
+
+        // Тот же пакет без недопустимого изменения применяется
+        if (seed % 2 == 0) batch.update_buses.pop_back();
+        else               batch.remove_stops.pop_back();
+
+        actual.handler.UpdateData(batch);
+        model = changed;
+        CheckAgainstFreshBuild(model, actual, random);
+    }
+}
+
+}
+
+int main() {
+    RUN_TEST(TestUpdatesMatchFreshBuild);
+    RUN_TEST(TestFailedBatchIsRolledBack);
+}
\ No newline at end of file